@@ -39,12 +39,27 @@
 #define FONT_SIZE_NORMAL 13
 #define FONT_SIZE_LARGE  16
 
+/* Glyph atlas - printable ASCII of one font pre-rasterized (white) into a
+ * single texture. Strings are drawn as one batch of textured quads with
+ * the color in the vertices, so nothing is rasterized per frame. */
+#define UI_ATLAS_FIRST      32
+#define UI_ATLAS_GLYPHS     95          /* ' ' .. '~' */
+
+typedef struct {
+    TTF_Font* font;
+    SDL_Texture* texture;
+    int tex_w, tex_h;
+    SDL_Rect glyph[UI_ATLAS_GLYPHS];    /* Source rect in the atlas */
+    int advance[UI_ATLAS_GLYPHS];
+} ui_glyph_atlas_t;
+
 /* UI Core context */
 typedef struct {
     SDL_Renderer* renderer;
     TTF_Font* font_small;
     TTF_Font* font_normal;
     TTF_Font* font_large;
+    ui_glyph_atlas_t atlas[3];          /* small, normal, large */
 } ui_core_t;
 
 /* Mouse state */
@@ -74,8 +89,8 @@ int ui_draw_text(ui_core_t* ui, TTF_Font* font, const char* text, int x, int y,
 /* Draw text centered in width */
 void ui_draw_text_centered(ui_core_t* ui, TTF_Font* font, const char* text, int x, int y, int w, uint32_t color);
 
-/* Get text size */
-void ui_get_text_size(TTF_Font* font, const char* text, int* w, int* h);
+/* Get text size as ui_draw_text will draw it */
+void ui_get_text_size(ui_core_t* ui, TTF_Font* font, const char* text, int* w, int* h);
 
 /* Check if point is in rectangle */
 bool ui_point_in_rect(int px, int py, int x, int y, int w, int h);
@@ -0,0 +1,36 @@
+/**
+ * @file wf_axis.h
+ * @brief Tick layout and labels for the frequency and time rulers
+ *
+ * Pure layout: given the visible span (or the time per row) and the
+ * screen size, pick a 1/2/5 x 10^n step that keeps labels at least
+ * min_spacing pixels apart and format each tick's label. The caller
+ * rasterizes the result once and reuses it until the inputs change.
+ */
+
+#ifndef WF_AXIS_H
+#define WF_AXIS_H
+
+#include <stdbool.h>
+
+#define WF_AXIS_MAX_TICKS   64
+#define WF_AXIS_LABEL_LEN   24
+
+typedef struct {
+    int pos;                            /* Pixel x (frequency) or y (time) */
+    char label[WF_AXIS_LABEL_LEN];
+} wf_axis_tick_t;
+
+/* Frequency ticks across width columns showing [left_hz, right_hz] relative
+ * to center_hz. Labels are absolute MHz when center_hz > 0, otherwise
+ * offsets in Hz/kHz. Returns the tick count. */
+int wf_axis_freq_ticks(double center_hz, double left_hz, double right_hz,
+                       int width, int min_spacing, wf_axis_tick_t* ticks);
+
+/* Time ticks down height rows, row_seconds apart; the row at y = 0 is
+ * start_seconds old (0 = live). Labels give each tick's age. Returns the
+ * tick count. */
+int wf_axis_time_ticks(double start_seconds, double row_seconds, int height,
+                       int min_spacing, wf_axis_tick_t* ticks);
+
+#endif /* WF_AXIS_H */
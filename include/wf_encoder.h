@@ -0,0 +1,56 @@
+/**
+ * @file wf_encoder.h
+ * @brief Background writer for headless frame snapshots and row streams
+ *
+ * The producer copies ARGB8888 pixels into a free slot and returns; one
+ * SDL thread converts them to 24-bit RGB and does the I/O, so a slow disk
+ * or pipe never stalls acquisition. When every slot is still queued, new
+ * ppm frames are dropped and counted rather than waited for; rgb rows wait
+ * for a free slot, since a stream with gaps would misplace every later row.
+ *
+ * Formats:
+ *   ppm - one binary P6 image per frame. To a file, each frame replaces
+ *         the last one atomically (written beside it, then renamed), so a
+ *         dashboard polling the path never reads half an image. To stdout
+ *         the images are concatenated (ffmpeg -f image2pipe).
+ *   rgb - bare rows, width * 3 bytes each, appended in order.
+ */
+
+#ifndef WF_ENCODER_H
+#define WF_ENCODER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    WF_ENCODER_PPM = 0,
+    WF_ENCODER_RGB,
+    WF_ENCODER_FORMAT_COUNT
+} wf_encoder_format_t;
+
+typedef struct wf_encoder wf_encoder_t;
+
+/* Start the writer thread. Path "-" is stdout: the encoder keeps the real
+ * stdout and the process's own console output is moved to stderr. */
+wf_encoder_t* wf_encoder_create(const char* path, wf_encoder_format_t format);
+
+/* Name <-> format ("ppm", "rgb"); unknown names give
+ * WF_ENCODER_FORMAT_COUNT */
+wf_encoder_format_t wf_encoder_format_from_name(const char* name);
+const char* wf_encoder_format_name(wf_encoder_format_t format);
+
+/* Slot of width x height ARGB pixels for the caller to fill. NULL when a
+ * ppm writer is behind (the frame is counted as dropped) or allocation
+ * fails; rgb blocks until the writer frees a slot. */
+uint32_t* wf_encoder_begin(wf_encoder_t* enc, int width, int height);
+
+/* Queue the slot filled since wf_encoder_begin */
+void wf_encoder_commit(wf_encoder_t* enc);
+
+/* Frames dropped because the writer fell behind */
+unsigned wf_encoder_dropped(const wf_encoder_t* enc);
+
+/* Write what is queued, stop the thread and close the output */
+void wf_encoder_destroy(wf_encoder_t* enc);
+
+#endif /* WF_ENCODER_H */
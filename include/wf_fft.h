@@ -0,0 +1,91 @@
+/**
+ * @file wf_fft.h
+ * @brief FFT plan cache and engine layer for the waterfall display
+ *
+ * Holds one plan per FFT size: the interleaved Blackman-Harris window plus
+ * the state of whichever engine was picked for that size. Plans are built
+ * on first request and kept until shutdown, so switching sizes at runtime
+ * is a table lookup and never allocates on the hot path once a size has
+ * been used.
+ *
+ * Engines:
+ *   - kiss:     phoenix-kiss-fft (mixed radix, interleaved complex)
+ *   - stockham: radix-4 Stockham autosort on split re/im arrays; every
+ *               inner loop is unit-stride so the compiler vectorizes it
+ *   - q15:      radix-2 on int16 split arrays, scaled by 1/2 per stage
+ *               (float window in, float bins out; noise floor ~80 dB
+ *               below full scale)
+ *
+ * With no override the fastest float engine for each size is measured once
+ * at startup and remembered in a wisdom file (see wf_fft_autotune). q15 is
+ * never picked automatically - only by name.
+ */
+
+#ifndef WF_FFT_H
+#define WF_FFT_H
+
+#include <stdbool.h>
+#include "kiss_fft.h"
+
+#define WF_FFT_MIN_SIZE     256
+#define WF_FFT_MAX_SIZE     65536
+
+/* Scratch needed by wf_fft_execute, in kiss_fft_cpx elements */
+#define WF_FFT_SCRATCH_SIZE(n)  (2 * (n))
+
+typedef enum {
+    WF_FFT_ENGINE_AUTO = -1,    /* Autotune (or wisdom) per size */
+    WF_FFT_ENGINE_KISS = 0,
+    WF_FFT_ENGINE_STOCKHAM,
+    WF_FFT_ENGINE_Q15,
+    WF_FFT_ENGINE_COUNT
+} wf_fft_engine_t;
+
+/* Cached FFT plan for one size */
+typedef struct {
+    int size;
+    wf_fft_engine_t engine;
+    void *state;        /* Engine-specific, read-only after creation */
+    float *window;      /* Interleaved (w0,w0,w1,w1,...), 2*size floats */
+} wf_fft_plan_t;
+
+/* Load wisdom from path (may be NULL) and set the engine override */
+void wf_fft_init(const char* wisdom_path, wf_fft_engine_t engine);
+
+/* Measure every size missing from the wisdom and save the winners. Blocks
+ * for up to a few seconds, so it runs at startup, before any plan is used;
+ * until then AUTO plans use kiss. */
+void wf_fft_autotune(void);
+
+/* Change the engine override. Cached plans of another engine are freed and
+ * rebuilt at the same address by the next wf_fft_get_plan, so no transform
+ * may be running and every in-use plan must be fetched again. */
+void wf_fft_set_engine(wf_fft_engine_t engine);
+
+/* Engine name <-> id ("kiss", "stockham", "q15", "auto"). Unknown names
+ * give WF_FFT_ENGINE_COUNT. */
+const char* wf_fft_engine_name(wf_fft_engine_t engine);
+wf_fft_engine_t wf_fft_engine_from_name(const char* name);
+
+/* True if size is a power of two within [WF_FFT_MIN_SIZE, WF_FFT_MAX_SIZE] */
+bool wf_fft_size_valid(int size);
+
+/* Get (building and autotuning on first use) the cached plan for size.
+ * NULL if size is invalid or allocation fails. */
+const wf_fft_plan_t* wf_fft_get_plan(int size);
+
+/* Window interleaved I/Q samples and transform: out = FFT(in * window).
+ * scratch must hold WF_FFT_SCRATCH_SIZE(size) elements. Plans are
+ * read-only here, so concurrent calls with separate scratch/out are safe. */
+void wf_fft_execute(const wf_fft_plan_t* plan, const kiss_fft_cpx* in,
+                    kiss_fft_cpx* scratch, kiss_fft_cpx* out);
+
+/* Time engine on noise input: seconds per transform (best of several
+ * trials), or < 0 if it can't run size. If err_db is set it receives the
+ * output error relative to kiss_fft, in dB. */
+double wf_fft_benchmark(wf_fft_engine_t engine, int size, double* err_db);
+
+/* Free all cached plans */
+void wf_fft_shutdown(void);
+
+#endif /* WF_FFT_H */
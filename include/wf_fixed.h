@@ -0,0 +1,59 @@
+/**
+ * @file wf_fixed.h
+ * @brief Fixed-point (Q15) front end for U8/S16 I/Q streams
+ *
+ * Integer replacement for "convert to float + FIR decimate" at the input
+ * rate, for boards without a fast FPU:
+ *
+ *   raw U8/S16 -> 3rd-order CIC (decimate by R, wrap-around uint32 math)
+ *              -> Q15 scale -> 128-tap Q15 FIR (decimate by 4) -> Q15 I/Q
+ *
+ * The CIC needs only additions per input sample; the FIR runs at 4x the
+ * output rate and is evaluated once per output sample. Total decimation is
+ * 4R, with R chosen so 4R is closest to the requested factor; callers
+ * derive the output rate from dec->factor.
+ *
+ * Only decimation is integer. The output is scaled back to float for the
+ * mixer, zoom decimator and window, and the q15 FFT engine quantizes the
+ * windowed block again before its int16 butterflies.
+ */
+
+#ifndef WF_FIXED_H
+#define WF_FIXED_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define WF_Q15_FIR_TAPS     128
+#define WF_Q15_FIR_DECIM    4
+#define WF_Q15_CIC_ORDER    3
+
+typedef struct { int16_t r, i; } wf_q15_cpx;
+
+typedef struct {
+    int factor;             /* Total decimation, 4 * cic_factor */
+    int cic_factor;         /* R */
+    int cic_count;
+    int in_shift;           /* Input pre-shift so CIC growth fits 32 bits */
+    int64_t scale;          /* CIC output -> Q15, Q32 multiplier */
+    uint32_t integ[2][WF_Q15_CIC_ORDER];   /* I, Q integrators */
+    uint32_t comb[2][WF_Q15_CIC_ORDER];    /* I, Q comb delays */
+    int16_t taps[WF_Q15_FIR_TAPS];
+    int16_t hist[2][2 * WF_Q15_FIR_TAPS];  /* Mirrored FIR history */
+    int hist_idx;
+    int fir_phase;
+} wf_q15_decim_t;
+
+/* Set up for total decimation ~factor on bits-wide input (9 for U8 after
+ * centering, 16 for S16). False if factor is too small for CIC + FIR. */
+bool wf_q15_decim_init(wf_q15_decim_t* dec, int factor, int bits);
+
+/* HOT PATH - decimate n interleaved I/Q pairs. out must hold
+ * n / dec->factor + 1 samples; returns the number written. */
+int wf_q15_decim_s16(wf_q15_decim_t* dec, const int16_t* iq, int n, wf_q15_cpx* out);
+int wf_q15_decim_u8(wf_q15_decim_t* dec, const uint8_t* iq, int n, wf_q15_cpx* out);
+
+/* Time the float and Q15 paths (decimation and FFT) and print a report */
+void wf_fixed_benchmark(int sample_rate, int output_rate);
+
+#endif /* WF_FIXED_H */
@@ -0,0 +1,53 @@
+/**
+ * @file wf_palette.h
+ * @brief Colormap lookup tables for the waterfall display
+ *
+ * A palette is a fixed WF_PALETTE_SIZE-entry color table built once when
+ * it is selected. Gain and the AGC range only change the affine dB ->
+ * index mapping (scale, offset), so colorizing a row is one multiply-add
+ * and clamp per column (vectorized) followed by a table lookup - no log,
+ * divide or per-pixel branch.
+ */
+
+#ifndef WF_PALETTE_H
+#define WF_PALETTE_H
+
+#include <stdint.h>
+
+#define WF_PALETTE_SIZE     1024
+
+typedef enum {
+    WF_PALETTE_CLASSIC = 0,     /* blue → cyan → green → yellow → red */
+    WF_PALETTE_GRAYSCALE,
+    WF_PALETTE_VIRIDIS,         /* Perceptually uniform, colorblind-safe */
+    WF_PALETTE_COUNT
+} wf_palette_id_t;
+
+typedef struct {
+    wf_palette_id_t id;
+    uint32_t color[WF_PALETTE_SIZE];    /* 0xAARRGGBB, A = 0xFF */
+} wf_palette_t;
+
+/* Palette name <-> id ("classic", "grayscale", "viridis") */
+const char* wf_palette_name(wf_palette_id_t id);
+wf_palette_id_t wf_palette_from_name(const char* name);
+
+/* Fill the table for id (out-of-range ids fall back to classic) */
+void wf_palette_build(wf_palette_t* pal, wf_palette_id_t id);
+
+/* Index mapping for dB values: index = db * scale + offset, so that
+ * floor_db maps to entry 0 and floor_db + range_db to the last entry.
+ * gain_db is added to every value first. */
+void wf_palette_scale(float floor_db, float range_db, float gain_db,
+                      float* scale, float* offset);
+
+/* HOT PATH - once per row block: colorize n dB values into ARGB8888 */
+void wf_palette_map_argb(const wf_palette_t* pal, const float* db, int n,
+                         float scale, float offset, uint32_t* argb);
+
+/* HOT PATH - same, for quantized dB codes: index = code * scale + offset
+ * (callers fold the code step and base into scale/offset) */
+void wf_palette_map_codes_argb(const wf_palette_t* pal, const uint8_t* codes, int n,
+                               float scale, float offset, uint32_t* argb);
+
+#endif /* WF_PALETTE_H */
@@ -0,0 +1,33 @@
+/**
+ * @file wf_pool.h
+ * @brief Minimal fork/join worker pool (SDL threads)
+ *
+ * wf_pool_run() hands out job indices to the helper threads and the
+ * calling thread, then returns once every job has finished. Each job is
+ * told which worker ran it (0 = caller, 1..workers = helpers), so callers
+ * can give every worker its own scratch buffers.
+ */
+
+#ifndef WF_POOL_H
+#define WF_POOL_H
+
+#include <stdbool.h>
+
+typedef struct wf_pool wf_pool_t;
+
+/* Job callback: job index in [0, jobs), worker index in [0, workers] */
+typedef void (*wf_pool_fn)(int job, int worker, void* ctx);
+
+/* Create a pool with the given number of helper threads (0 = none) */
+wf_pool_t* wf_pool_create(int workers);
+
+/* Number of helper threads (total parallelism is this + 1) */
+int wf_pool_workers(const wf_pool_t* pool);
+
+/* Run jobs [0, jobs) and block until all are done. NULL pool runs inline. */
+void wf_pool_run(wf_pool_t* pool, int jobs, wf_pool_fn fn, void* ctx);
+
+/* Stop and join all helper threads */
+void wf_pool_destroy(wf_pool_t* pool);
+
+#endif /* WF_POOL_H */
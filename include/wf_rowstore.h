@@ -0,0 +1,79 @@
+/**
+ * @file wf_rowstore.h
+ * @brief Memory-mapped ring of quantized waterfall rows with time mipmaps
+ *
+ * Rows are fixed-width 8-bit codes with a per-row base (dB of code 0 =
+ * base_db, each code step_db), the same format as the on-screen history,
+ * plus the frequency span the columns covered. Level 0 keeps every row;
+ * level k keeps the max of 2^k consecutive level-0 rows, built as pairs of
+ * level k-1 rows complete. Every level has the same row capacity, so level
+ * k reaches 2^k times further back. Rows of different spans are never
+ * max-merged: a pair that straddles a span change keeps its newer row.
+ *
+ * Rows are addressed by absolute index (rows ever appended to that level).
+ * Level-k row j covers level-0 rows [j << k, (j + 1) << k), so a view at
+ * any age and time scale reads exactly one stored row per screen row -
+ * O(visible pixels) however long the history is.
+ *
+ * The store is a file mapped into memory. The OS pages in what is viewed
+ * and writes back what is appended, so hours of spectra never have to sit
+ * in RAM. Partial mip rows live in the file too: reopening a file with the
+ * same geometry resumes it exactly.
+ */
+
+#ifndef WF_ROWSTORE_H
+#define WF_ROWSTORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define WF_ROWSTORE_MAX_LEVELS  16
+
+typedef struct wf_rowstore_header wf_rowstore_header_t;
+
+/* Frequencies of a row's first and last column, relative to center_hz
+ * (the arguments of wf_axis_freq_ticks) */
+typedef struct {
+    double center_hz;
+    float left_hz;
+    float right_hz;
+} wf_rowstore_span_t;
+
+typedef struct {
+    int width;                          /* Codes per row */
+    int levels;                         /* Level 0 plus levels-1 mips */
+    int capacity;                       /* Rows kept per level */
+    float step_db;                      /* dB per code */
+    wf_rowstore_header_t *header;       /* Start of the mapping */
+    uint8_t *map;
+    size_t map_size;
+    size_t level_bytes;                 /* Codes + bases + spans of one level */
+#ifdef _WIN32
+    void *file;
+    void *mapping;
+#else
+    int fd;
+#endif
+} wf_rowstore_t;
+
+/* Map path, creating or resizing the file when it does not match the
+ * requested geometry (its old contents are then discarded). */
+bool wf_rowstore_open(wf_rowstore_t* st, const char* path, int width,
+                      int capacity, int levels, float step_db);
+void wf_rowstore_close(wf_rowstore_t* st);
+
+/* Append one row and fold it into the mip levels */
+void wf_rowstore_append(wf_rowstore_t* st, const uint8_t* codes, float base_db,
+                        const wf_rowstore_span_t* span);
+
+/* Rows ever appended to a level (the next index to be written) */
+uint64_t wf_rowstore_written(const wf_rowstore_t* st, int level);
+
+/* Row at absolute index of a level, or NULL if not yet written or already
+ * overwritten. The pointer stays valid until the next append. base_db and
+ * span may be NULL. */
+const uint8_t* wf_rowstore_row(const wf_rowstore_t* st, int level,
+                               uint64_t index, float* base_db, wf_rowstore_span_t* span);
+
+#endif /* WF_ROWSTORE_H */
@@ -0,0 +1,56 @@
+/**
+ * @file wf_sdft.h
+ * @brief Sliding DFT - incremental spectrum for a subset of bins
+ *
+ * Tracks only the bins the screen actually shows: the bin nearest each
+ * column center plus its two neighbours, used to apply a Hann window in
+ * the frequency domain (Y = X/2 - (X[k-1] + X[k+1])/4). Bins shared by
+ * adjacent columns are tracked once, so the set is at most 3 * columns and
+ * never more than the bins in the span. Every new sample updates each
+ * tracked bin with one double-precision complex multiply:
+ *
+ *   X_k <- (X_k + x_new - x_old) * exp(+j*2*pi*k/N)
+ *
+ * The FFT path costs about (N/2)log2(N)/hop butterflies per sample, so
+ * this only wins when count < (N/2)log2(N)/hop: small hops, or large N
+ * with few columns. At the default 2048/256 on a wide window it is the
+ * more expensive mode. A row can be read out after any number of samples.
+ * Accumulators are double precision, which keeps the undamped recursion
+ * stable for days of streaming; state is seeded from an exact FFT of the
+ * current history.
+ */
+
+#ifndef WF_SDFT_H
+#define WF_SDFT_H
+
+#include <stdbool.h>
+#include "wf_spectrum.h"
+
+typedef struct {
+    int size;           /* N */
+    int count;          /* Tracked bins */
+    int capacity;
+    int columns;
+    int col_capacity;
+    double *re, *im;    /* Running DFT per tracked bin */
+    double *w_re, *w_im;/* exp(+j*2*pi*k/N) per tracked bin */
+    int *col_slot;      /* 3 slots per column: k-1, k, k+1 */
+    int *col_bin;       /* Natural-order bin index of each column's center */
+} wf_sdft_t;
+
+/* Track the center bin of every column in map (built with nearest=true).
+ * history points at the newest N I/Q pairs (interleaved floats, oldest first). */
+bool wf_sdft_configure(wf_sdft_t* sdft, const wf_colmap_t* map, int size,
+                       const float* history);
+
+/* HOT PATH - per sample: push x_new, drop x_old (the sample N back) */
+void wf_sdft_update(wf_sdft_t* sdft, float new_i, float new_q, float old_i, float old_q);
+
+/* Hann-windowed |Y|^2 of each column's center bin, written at its natural
+ * bin index in power[N]. Other entries are left untouched. */
+void wf_sdft_power(const wf_sdft_t* sdft, float* power);
+
+/* Free buffers */
+void wf_sdft_free(wf_sdft_t* sdft);
+
+#endif /* WF_SDFT_H */
@@ -0,0 +1,183 @@
+/**
+ * @file wf_spectrum.h
+ * @brief Per-bin power spectrum processing for the waterfall display
+ *
+ * Welch averaging: each output row is the mean (or max-hold) of K
+ * overlapped periodograms. Frames are folded into a running accumulator as
+ * they arrive, so the cost is one FFT plus one pass over the bins per hop,
+ * not K FFTs per row. Row rate drops by K; noise variance drops by ~K.
+ *
+ * Column mapping: a per-column bin range table, rebuilt only when the
+ * window width, zoom span or FFT size changes. Columns covering several
+ * bins are max- or mean-pooled so narrow carriers never alias away;
+ * columns narrower than a bin are linearly interpolated. Nearest mode
+ * maps each column to the single bin at its center (sliding DFT rows).
+ *
+ * Everything up to wf_power_to_db stays in |X|^2; dB is computed once
+ * per column with a vectorizable fast log2 and shared by AGC and color.
+ *
+ * AGC: each row's dB values go into a coarse 1 dB histogram as they are
+ * produced. Floor and peak are percentiles of that histogram, so a single
+ * spike or empty bin can't swing the color range. They are smoothed with
+ * attack/decay time constants given in seconds.
+ *
+ * Flattening: a per-bin noise floor (slow quantile tracker in log2 power)
+ * divides each completed row, removing the receiver passband shape and the
+ * DC spike. Only 1/WF_FLATTEN_SLICES of the bins are re-estimated per row;
+ * applying the gains is one multiply per bin.
+ *
+ * Traces: current, exponentially averaged and peak-hold dB per screen
+ * column, rebuilt from each row's quantized codes with straight loops over
+ * the columns (vectorized).
+ */
+
+#ifndef WF_SPECTRUM_H
+#define WF_SPECTRUM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "kiss_fft.h"
+
+#define WF_WELCH_MAX_FRAMES     64
+
+#define WF_FLATTEN_SLICES       8       /* Rows per full floor update */
+
+#define WF_AGC_HIST_BINS        256     /* 1 dB each */
+#define WF_AGC_HIST_MIN_DB      (-200.0f)
+
+/* Welch averager state */
+typedef struct {
+    int bins;           /* Current FFT size */
+    int frames;         /* K - periodograms per row */
+    int count;          /* Periodograms accumulated so far */
+    bool max_hold;      /* Max instead of mean */
+    float *acc;         /* Running sum (or max) of |X|^2 per bin */
+    float *power;       /* Last completed row, |X|^2 per bin, FFT-shifted (DC at bins/2) */
+} wf_welch_t;
+
+/* Column pooling mode */
+typedef enum {
+    WF_POOL_MAX = 0,
+    WF_POOL_MEAN
+} wf_pool_mode_t;
+
+/* Column -> bin range table */
+typedef struct {
+    int columns;
+    int capacity;       /* Allocated columns */
+    int bins;
+    int max_count;      /* Widest column, in bins */
+    bool interpolate;   /* Bins wider than columns: start=i0, weight=fraction */
+    int *start;         /* First bin per column (FFT-shifted index) */
+    int *count;         /* Bins per column */
+    float *weight;      /* 1/count (pooling) or interpolation fraction */
+} wf_colmap_t;
+
+/* Per-bin noise floor tracker */
+typedef struct {
+    int bins;           /* Bins currently tracked (0 = not primed) */
+    int capacity;
+    int phase;          /* Slice re-estimated next row */
+    float quantile;     /* Tracked quantile of each bin's power, 0..1 */
+    float *level;       /* log2 floor estimate per bin */
+    float *gain;        /* 2^-level */
+} wf_flatten_t;
+
+/* Percentile AGC state */
+typedef struct {
+    uint32_t hist[WF_AGC_HIST_BINS];    /* Current row */
+    uint32_t count;
+    float floor_pct;    /* Noise floor percentile, 0..1 */
+    float peak_pct;     /* Peak percentile, 0..1 */
+    float attack_s;     /* Time constant towards a wider range */
+    float decay_s;      /* Time constant towards a narrower range */
+    float floor_db;     /* Smoothed outputs used for coloring */
+    float peak_db;
+} wf_agc_t;
+
+/* Spectrum traces, one value per screen column */
+typedef struct {
+    int columns;
+    int capacity;
+    bool primed;        /* avg/peak hold data */
+    float *current;     /* dB of the newest row */
+    float *average;
+    float *peak;
+} wf_trace_t;
+
+/* Allocate for up to max_bins bins */
+bool wf_welch_init(wf_welch_t* welch, int max_bins);
+
+/* Free buffers */
+void wf_welch_free(wf_welch_t* welch);
+
+/* Set FFT size, K and mode; discards any partial row */
+void wf_welch_configure(wf_welch_t* welch, int bins, int frames, bool max_hold);
+
+/* power[k] = |fft_out[k]|^2 (natural bin order) */
+void wf_fft_power(const kiss_fft_cpx* fft_out, float* power, int n);
+
+/* Fold one frame's |X|^2 (from wf_fft_power) into the accumulator. Frames
+ * must arrive in hop order. Returns true when K frames have been collected
+ * and welch->power holds a new row. */
+bool wf_welch_add(wf_welch_t* welch, const float* frame_power);
+
+/* Build the table for columns spanning [f_lo, f_hi) Hz around DC. With
+ * nearest, every column reads only the bin closest to its center.
+ * Grows buffers only when columns exceeds the previous capacity. */
+bool wf_colmap_build(wf_colmap_t* map, int columns, int bins, float bin_hz,
+                     float f_lo, float f_hi, bool nearest);
+
+/* Free table buffers */
+void wf_colmap_free(wf_colmap_t* map);
+
+/* Pool FFT-shifted power[bins] into out[0..cols) for columns
+ * [first, first+cols). Callers process the row in cache-sized blocks. */
+void wf_colmap_apply(const wf_colmap_t* map, const float* power,
+                     wf_pool_mode_t mode, int first, int cols, float* out);
+
+/* db[i] = 10*log10(power[i]) + offset_db, accurate to ~3e-4 dB */
+void wf_power_to_db(const float* power, float* db, int n, float offset_db);
+
+/* Allocate for up to max_bins bins, tracking the given quantile */
+bool wf_flatten_init(wf_flatten_t* fl, int max_bins, float quantile);
+
+/* Free buffers */
+void wf_flatten_free(wf_flatten_t* fl);
+
+/* Forget the estimate; the next row re-primes every bin */
+void wf_flatten_reset(wf_flatten_t* fl);
+
+/* HOT PATH - once per row: update one slice of the floor estimate from
+ * power[bins], then divide the whole row by it in place. db_per_second
+ * is how fast the estimate may move. */
+void wf_flatten_apply(wf_flatten_t* fl, float* power, int bins,
+                      float db_per_second, float row_seconds);
+
+/* Set percentiles, time constants and the starting range */
+void wf_agc_init(wf_agc_t* agc, float floor_pct, float peak_pct,
+                 float attack_s, float decay_s, float floor_db, float peak_db);
+
+/* HOT PATH - add n dB values of the current row to the histogram */
+void wf_agc_accumulate(wf_agc_t* agc, const float* db, int n);
+
+/* End of row: move floor/peak towards this row's percentiles over
+ * row_seconds of elapsed time, then clear the histogram */
+void wf_agc_update(wf_agc_t* agc, float row_seconds);
+
+/* Size for columns (grows buffers as needed) and clear the traces */
+bool wf_trace_resize(wf_trace_t* tr, int columns);
+
+/* Free buffers */
+void wf_trace_free(wf_trace_t* tr);
+
+/* Forget average and peak; the next row re-primes them */
+void wf_trace_reset(wf_trace_t* tr);
+
+/* HOT PATH - once per row: current = base_db + code * step_db, then the
+ * average moves avg_alpha of the way there and the peak decays by
+ * peak_decay_db before taking the max */
+void wf_trace_update(wf_trace_t* tr, const uint8_t* codes, float base_db, float step_db,
+                     float avg_alpha, float peak_decay_db);
+
+#endif /* WF_SPECTRUM_H */
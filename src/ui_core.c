@@ -16,6 +16,9 @@
 #define FONT_PATH_FALLBACK  "/usr/share/fonts/TTF/DejaVuSansMono.ttf"
 #endif
 
+#define ATLAS_WIDTH         512
+#define BATCH_GLYPHS        64          /* Quads per SDL_RenderGeometry call */
+
 static TTF_Font* load_font(const char* primary, const char* fallback, int size) {
     TTF_Font* font = TTF_OpenFont(primary, size);
     if (!font && fallback) {
@@ -27,6 +30,142 @@ static TTF_Font* load_font(const char* primary, const char* fallback, int size)
     return font;
 }
 
+/*============================================================================
+ * Glyph Atlas
+ *============================================================================*/
+
+static void atlas_build(SDL_Renderer* renderer, ui_glyph_atlas_t* atlas, TTF_Font* font) {
+    memset(atlas, 0, sizeof(*atlas));
+    atlas->font = font;
+    if (!font) return;
+
+    /* Rasterize each glyph once, shelf-pack them into one sheet */
+    SDL_Surface* glyphs[UI_ATLAS_GLYPHS] = {0};
+    SDL_Color white = { 255, 255, 255, 255 };
+    int x = 0, y = 0, row_h = 0;
+    for (int g = 0; g < UI_ATLAS_GLYPHS; g++) {
+        Uint16 ch = (Uint16)(UI_ATLAS_FIRST + g);
+        TTF_GlyphMetrics(font, ch, NULL, NULL, NULL, NULL, &atlas->advance[g]);
+        glyphs[g] = TTF_RenderGlyph_Blended(font, ch, white);
+        if (!glyphs[g]) continue;
+        if (x + glyphs[g]->w > ATLAS_WIDTH) {
+            x = 0;
+            y += row_h + 1;
+            row_h = 0;
+        }
+        atlas->glyph[g] = (SDL_Rect){ x, y, glyphs[g]->w, glyphs[g]->h };
+        x += glyphs[g]->w + 1;
+        if (glyphs[g]->h > row_h) row_h = glyphs[g]->h;
+    }
+
+    SDL_Surface* sheet = NULL;
+    if (y + row_h > 0) {
+        sheet = SDL_CreateRGBSurfaceWithFormat(0, ATLAS_WIDTH, y + row_h, 32, SDL_PIXELFORMAT_ARGB8888);
+    }
+    for (int g = 0; g < UI_ATLAS_GLYPHS; g++) {
+        if (!glyphs[g]) continue;
+        if (sheet) {
+            SDL_SetSurfaceBlendMode(glyphs[g], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(glyphs[g], NULL, sheet, &atlas->glyph[g]);
+        }
+        SDL_FreeSurface(glyphs[g]);
+    }
+    if (!sheet) return;
+
+    atlas->texture = SDL_CreateTextureFromSurface(renderer, sheet);
+    if (atlas->texture) {
+        SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+        atlas->tex_w = sheet->w;
+        atlas->tex_h = sheet->h;
+    } else {
+        fprintf(stderr, "Glyph atlas texture failed: %s\n", SDL_GetError());
+    }
+    SDL_FreeSurface(sheet);
+}
+
+static ui_glyph_atlas_t* atlas_for(ui_core_t* ui, TTF_Font* font) {
+    for (int a = 0; a < 3; a++) {
+        if (ui->atlas[a].font == font && ui->atlas[a].texture) return &ui->atlas[a];
+    }
+    return NULL;
+}
+
+static bool atlas_covers(const char* text) {
+    for (const unsigned char* p = (const unsigned char*)text; *p; p++) {
+        if (*p < UI_ATLAS_FIRST || *p >= UI_ATLAS_FIRST + UI_ATLAS_GLYPHS) return false;
+    }
+    return true;
+}
+
+/* One SDL_RenderGeometry call per BATCH_GLYPHS glyphs */
+static int atlas_draw(ui_core_t* ui, const ui_glyph_atlas_t* atlas, const char* text,
+                      int x, int y, SDL_Color color) {
+    SDL_Vertex verts[BATCH_GLYPHS * 4];
+    int indices[BATCH_GLYPHS * 6];
+    const float inv_w = 1.0f / (float)atlas->tex_w;
+    const float inv_h = 1.0f / (float)atlas->tex_h;
+    int pen = x;
+    int n = 0;
+
+    for (const unsigned char* p = (const unsigned char*)text; *p; p++) {
+        int g = *p - UI_ATLAS_FIRST;
+        const SDL_Rect* src = &atlas->glyph[g];
+        if (src->w > 0) {
+            if (n == BATCH_GLYPHS) {
+                SDL_RenderGeometry(ui->renderer, atlas->texture, verts, n * 4, indices, n * 6);
+                n = 0;
+            }
+            float x0 = (float)pen, y0 = (float)y;
+            float x1 = x0 + src->w, y1 = y0 + src->h;
+            float u0 = src->x * inv_w, v0 = src->y * inv_h;
+            float u1 = (src->x + src->w) * inv_w, v1 = (src->y + src->h) * inv_h;
+            SDL_Vertex* v = &verts[n * 4];
+            v[0] = (SDL_Vertex){ { x0, y0 }, color, { u0, v0 } };
+            v[1] = (SDL_Vertex){ { x1, y0 }, color, { u1, v0 } };
+            v[2] = (SDL_Vertex){ { x1, y1 }, color, { u1, v1 } };
+            v[3] = (SDL_Vertex){ { x0, y1 }, color, { u0, v1 } };
+            int* idx = &indices[n * 6];
+            int base = n * 4;
+            idx[0] = base; idx[1] = base + 1; idx[2] = base + 2;
+            idx[3] = base; idx[4] = base + 2; idx[5] = base + 3;
+            n++;
+        }
+        pen += atlas->advance[g];
+    }
+    if (n > 0) {
+        SDL_RenderGeometry(ui->renderer, atlas->texture, verts, n * 4, indices, n * 6);
+    }
+    return pen - x;
+}
+
+/* Pen advance atlas_draw would move for text */
+static int atlas_measure(const ui_glyph_atlas_t* atlas, const char* text) {
+    int w = 0;
+    for (const unsigned char* p = (const unsigned char*)text; *p; p++) {
+        w += atlas->advance[*p - UI_ATLAS_FIRST];
+    }
+    return w;
+}
+
+/* Text outside the atlas (non-ASCII) - rasterized on every call */
+static int slow_draw(ui_core_t* ui, TTF_Font* font, const char* text,
+                     int x, int y, SDL_Color color) {
+    SDL_Surface* surface = TTF_RenderText_Blended(font, text, color);
+    if (!surface) return 0;
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(ui->renderer, surface);
+    int w = surface->w;
+    SDL_Rect dst = { x, y, surface->w, surface->h };
+    SDL_FreeSurface(surface);
+    if (!texture) return 0;
+    SDL_RenderCopy(ui->renderer, texture, NULL, &dst);
+    SDL_DestroyTexture(texture);
+    return w;
+}
+
+/*============================================================================
+ * Init / Shutdown
+ *============================================================================*/
+
 ui_core_t* ui_core_init(SDL_Renderer* renderer) {
     if (TTF_Init() < 0) {
         fprintf(stderr, "TTF_Init failed: %s\n", TTF_GetError());
@@ -45,11 +184,18 @@ ui_core_t* ui_core_init(SDL_Renderer* renderer) {
         fprintf(stderr, "Warning: Some fonts failed to load\n");
     }
 
+    atlas_build(renderer, &ui->atlas[0], ui->font_small);
+    atlas_build(renderer, &ui->atlas[1], ui->font_normal);
+    atlas_build(renderer, &ui->atlas[2], ui->font_large);
+
     return ui;
 }
 
 void ui_core_shutdown(ui_core_t* ui) {
     if (!ui) return;
+    for (int a = 0; a < 3; a++) {
+        if (ui->atlas[a].texture) SDL_DestroyTexture(ui->atlas[a].texture);
+    }
     if (ui->font_small) TTF_CloseFont(ui->font_small);
     if (ui->font_normal) TTF_CloseFont(ui->font_normal);
     if (ui->font_large) TTF_CloseFont(ui->font_large);
@@ -87,40 +233,35 @@ int ui_draw_text(ui_core_t* ui, TTF_Font* font, const char* text, int x, int y,
         color & 0xFF
     };
 
-    SDL_Surface* surface = TTF_RenderText_Blended(font, text, sdl_color);
-    if (!surface) return 0;
-
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(ui->renderer, surface);
-    if (!texture) {
-        SDL_FreeSurface(surface);
-        return 0;
+    ui_glyph_atlas_t* atlas = atlas_for(ui, font);
+    if (atlas && atlas_covers(text)) {
+        return atlas_draw(ui, atlas, text, x, y, sdl_color);
     }
-
-    SDL_Rect dst = { x, y, surface->w, surface->h };
-    SDL_RenderCopy(ui->renderer, texture, NULL, &dst);
-
-    int width = surface->w;
-    SDL_FreeSurface(surface);
-    SDL_DestroyTexture(texture);
-
-    return width;
+    return slow_draw(ui, font, text, x, y, sdl_color);
 }
 
 void ui_draw_text_centered(ui_core_t* ui, TTF_Font* font, const char* text, 
                             int x, int y, int w, uint32_t color) {
     if (!font || !text) return;
     int text_w, text_h;
-    TTF_SizeText(font, text, &text_w, &text_h);
+    ui_get_text_size(ui, font, text, &text_w, &text_h);
     int offset_x = (w - text_w) / 2;
     ui_draw_text(ui, font, text, x + offset_x, y, color);
 }
 
-void ui_get_text_size(TTF_Font* font, const char* text, int* w, int* h) {
+void ui_get_text_size(ui_core_t* ui, TTF_Font* font, const char* text, int* w, int* h) {
     if (!font || !text) {
         if (w) *w = 0;
         if (h) *h = 0;
         return;
     }
+    /* Same metrics ui_draw_text will use, so aligned labels line up */
+    ui_glyph_atlas_t* atlas = atlas_for(ui, font);
+    if (atlas && atlas_covers(text)) {
+        if (w) *w = atlas_measure(atlas, text);
+        if (h) *h = TTF_FontHeight(font);
+        return;
+    }
     TTF_SizeText(font, text, w, h);
 }
 
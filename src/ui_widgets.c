@@ -193,7 +193,7 @@ void widget_input_draw(widget_input_t* input, ui_core_t* ui) {
             strncpy(temp, input->text, input->cursor);
             temp[input->cursor] = '\0';
             int tw, th;
-            ui_get_text_size(ui->font_normal, temp, &tw, &th);
+            ui_get_text_size(ui, ui->font_normal, temp, &tw, &th);
             cursor_x += tw;
         }
         /* Blink cursor */
@@ -8,16 +8,30 @@
  * Connects to sdr_server via phoenix-discovery for raw I/Q stream.
  * Uses phoenix-dsp for decimation/filtering, phoenix-kiss-fft for FFT.
  *
- * HOT PATH (per-frame with samples):
+ * HOT PATH (DSP thread, per frame with samples):
  *   1. Receive IQDQ frames from sdr_server (PHXI/IQDQ protocol)
  *   2. Convert samples to float32 (S16/F32/U8 formats supported)
  *   3. Decimate from 2 MHz to 12 kHz display rate
- *   4. Accumulate in circular buffer
- *   5. Apply window function and compute FFT
- *   6. Calculate magnitudes and map to screen pixels
- *   7. Auto-gain tracking (attack/decay)
- *   8. Scroll waterfall and draw new row
- *   9. Render to screen
+ *      (fixed-point mode: U8/S16 go straight through a Q15 CIC + FIR
+ *      decimator instead of steps 2-3, then back to float for step 3a;
+ *      the q15 FFT engine does the butterflies of step 5 in int16)
+ *   3a. Zoom: mix pan frequency to DC, decimate by 2^zoom
+ *   4. Accumulate in mirrored circular buffer (no per-sample modulo)
+ *   5. Window + FFT + |X|^2 for every pending hop (parallel worker pool)
+ *      (sliding DFT mode: visible bins updated per sample in step 4,
+ *      read out at each hop boundary instead)
+ *   5a. Fold |X|^2 into Welch accumulator in hop order (row every K hops)
+ *   5b. Optional: divide row by tracked per-bin noise floor (flatten)
+ *   6. Fused row kernel, one pass over columns in cache-sized blocks:
+ *      pool bins → dB (fast log2) → AGC histogram → 8-bit dB codes
+ *   7. Auto-gain: floor/peak percentiles, attack/decay in seconds
+ *      (applies from the next row)
+ *   8. Queue the row for the render thread
+ *
+ * RENDER THREAD (once per display refresh):
+ *   1. Apply every queued row: codes into the history ring, palette LUT
+ *      into the ARGB pixel ring (full recolor on gain/palette/range change)
+ *   2. Upload the dirty rows, present as two copies split at the ring head
  *
  * Features:
  *   - Auto-discovery and auto-connect to sdr_server
@@ -25,6 +39,14 @@
  *   - PHXI/IQDQ protocol with sequence tracking
  *   - Sample format conversion (S16/F32/U8)
  *   - Decimation (2 MSPS → 12 kHz)
+ *   - Runtime FFT size (256-65536) and hop, cached plans per size
+ *   - Pluggable FFT engines (kiss, Stockham) autotuned per size
+ *   - Welch averaging (mean or max-hold of K FFTs per row)
+ *   - Column max/mean pooling via precomputed column-to-bin table
+ *   - Mouse-wheel zoom (real resolution via second decimation) and pan
+ *   - Parallel FFTs across pending hops for small hops / large sizes
+ *   - Sliding DFT mode: per-sample update of on-screen bins only
+ *   - Fixed-point (Q15) decimation and FFT for U8/S16 on small boards
  *   - Settings panel (Tab key)
  *   - Resizable window
  *   - Gain adjustment (+/- keys)
@@ -40,6 +62,15 @@
 
 #include <SDL.h>
 #include "kiss_fft.h"
+#include "wf_fft.h"
+#include "wf_spectrum.h"
+#include "wf_pool.h"
+#include "wf_sdft.h"
+#include "wf_fixed.h"
+#include "wf_palette.h"
+#include "wf_axis.h"
+#include "wf_rowstore.h"
+#include "wf_encoder.h"
 #include "version.h"
 #include "pn_discovery.h"
 #include "pn_dsp.h"
@@ -132,12 +163,24 @@ typedef struct {
 #define DEFAULT_RELAY_HOST      "localhost"
 #define DEFAULT_RELAY_PORT      4536  /* sdr_server data port */
 #define CONFIG_FILE             "waterfall.ini"
+#define WISDOM_FILE             "waterfall.wisdom"
 
 #define DISPLAY_SAMPLE_RATE     12000
-#define DISPLAY_FFT_SIZE        2048
-#define DISPLAY_OVERLAP         256   /* Update every 256 samples (~21ms at 12kHz) for smooth scrolling */
-#define DISPLAY_HZ_PER_BIN      ((float)DISPLAY_SAMPLE_RATE / DISPLAY_FFT_SIZE)
-#define ZOOM_MAX_HZ             5000.0f
+#define DEFAULT_FFT_SIZE        2048
+#define DEFAULT_FFT_HOP         256   /* Update every 256 samples (~21ms at 12kHz) for smooth scrolling */
+#define IQ_RING_SIZE            (2 * WF_FFT_MAX_SIZE)  /* Largest FFT plus pending-hop backlog */
+#define MAX_PENDING_HOPS        32    /* FFTs batched per pass; older hops are dropped */
+#define MAX_FFT_THREADS         8
+#define ZOOM_MAX_HZ             5000.0f   /* Half-span at zoom level 0 */
+#define ZOOM_MAX_LEVEL          6         /* 2^6 = 64x → ±78 Hz span */
+#define BENCHMARK_SAMPLE_RATE   2000000   /* --benchmark input rate */
+
+/* Build with -DWF_FIXED_POINT_DEFAULT=1 (CMake WATERFALL_FIXED_POINT=ON)
+ * to make the Q15 front end the default; --fixed-point / fixed_point= in
+ * the ini still override it at run time. */
+#ifndef WF_FIXED_POINT_DEFAULT
+#define WF_FIXED_POINT_DEFAULT  0
+#endif
 
 #define DEFAULT_WINDOW_WIDTH    1024
 #define DEFAULT_WINDOW_HEIGHT   600
@@ -145,7 +188,7 @@ typedef struct {
 #define MIN_WINDOW_HEIGHT       300
 
 #define PANEL_WIDTH             250
-#define PANEL_HEIGHT            220
+#define PANEL_HEIGHT            315
 
 /*============================================================================
  * Global State
@@ -155,8 +198,10 @@ typedef struct {
 static socket_t g_socket = SOCKET_INVALID;
 static char g_relay_host[256] = DEFAULT_RELAY_HOST;
 static int g_relay_port = DEFAULT_RELAY_PORT;
-static bool g_connected = false;
+static volatile bool g_connected = false;    /* Written by the DSP thread only */
 static uint32_t g_sample_rate = DISPLAY_SAMPLE_RATE;
+static uint64_t g_center_freq_hz = 0;   /* PHXI/META, under g_dsp_lock */
+static SDL_atomic_t g_center_serial;    /* Bumped on every center change */
 
 /* Discovery */
 static bool g_discovery_enabled = true;
@@ -173,14 +218,40 @@ static uint32_t g_sample_format = SAMPLE_FORMAT_F32;
 static uint32_t g_last_sequence = 0;
 static uint8_t *g_raw_buffer = NULL;
 static int g_raw_buffer_size = 0;
+static float *g_sample_buffer = NULL;
+static int g_sample_buffer_size = 0;
 
 /* Decimation (2 MSPS → 12 kHz) */
 static pn_decimate_t g_decimator_i;
 static pn_decimate_t g_decimator_q;
+static float g_display_rate = DISPLAY_SAMPLE_RATE;  /* Actual decimator output, under g_dsp_lock */
+
+/* Fixed-point front end - replaces the float decimators for U8/S16 */
+static bool g_fixed_point = WF_FIXED_POINT_DEFAULT;
+static bool g_q15_active = false;   /* Current stream uses g_q15_decim */
+static wf_q15_decim_t g_q15_decim;
+static wf_q15_cpx *g_q15_buffer = NULL;
+static int g_q15_buffer_size = 0;
 
 /* Auto-reconnect */
 #define RECONNECT_INTERVAL_MS 5000
-static uint32_t g_last_reconnect_time = 0;
+static volatile uint32_t g_last_reconnect_time = 0;
+
+/* DSP thread - acquisition, FFT and the row kernel run off the render
+ * thread. g_dsp_lock guards the DSP state (I/Q ring, zoom, FFT and Welch
+ * settings, column map, flatten, AGC); the render thread takes it around
+ * each event it handles. The socket belongs to the DSP thread, which
+ * connects and disconnects on request. */
+enum { LINK_NONE = 0, LINK_CONNECT, LINK_DISCONNECT };
+static SDL_Thread *g_dsp_thread = NULL;
+static SDL_mutex *g_dsp_lock = NULL;
+static SDL_atomic_t g_dsp_quit;
+static SDL_atomic_t g_link_request;     /* LINK_* for the DSP thread */
+
+/* Rendering - present at display refresh, applying all queued rows */
+#define FRAME_INTERVAL_MS       16      /* Pacing when vsync is unavailable */
+#define IDLE_POLL_MS            10      /* Nothing to draw */
+static bool g_vsync = false;
 
 /* Window */
 static int g_window_width = DEFAULT_WINDOW_WIDTH;
@@ -188,43 +259,261 @@ static int g_window_height = DEFAULT_WINDOW_HEIGHT;
 static SDL_Window *g_window = NULL;
 static SDL_Renderer *g_renderer = NULL;
 static SDL_Texture *g_texture = NULL;
-static uint8_t *g_pixels = NULL;
-
-/* FFT */
-static kiss_fft_cfg g_fft_cfg = NULL;
-static kiss_fft_cpx *g_fft_in = NULL;
-static kiss_fft_cpx *g_fft_out = NULL;
-static float *g_window_func = NULL;
-static float *g_magnitudes = NULL;
-
-/* I/Q buffer */
+static int g_texture_width = 0;         /* Allocated size, may exceed the window */
+static int g_texture_height = 0;
+static int g_max_texture_width = 0;     /* Renderer limits, 0 = unknown */
+static int g_max_texture_height = 0;
+static uint32_t *g_pixels = NULL;       /* ARGB8888 ring, rows indexed like g_history */
+static size_t g_pixels_capacity = 0;
+static int g_dirty_rows = 0;            /* Rows from the head not yet uploaded */
+
+/* Drag-resizing fires a burst of events - apply the last one once the
+ * window has settled, and batch config writes the same way */
+#define RESIZE_SETTLE_MS        150
+#define CONFIG_SAVE_DELAY_MS    2000
+static bool g_resize_pending = false;
+static int g_resize_width = 0;
+static int g_resize_height = 0;
+static uint32_t g_resize_due = 0;
+static bool g_config_dirty = false;
+static uint32_t g_config_due = 0;
+
+/* FFT (size/hop selectable at runtime; buffers sized for WF_FFT_MAX_SIZE) */
+static int g_fft_size = DEFAULT_FFT_SIZE;
+static int g_fft_hop = DEFAULT_FFT_HOP;
+static wf_fft_engine_t g_fft_engine = WF_FFT_ENGINE_AUTO;
+static const wf_fft_plan_t *g_fft_plan = NULL;
+
+/* FFT workers - each pending hop is one pool job. Every worker has its own
+ * scratch/output; every hop slot its own |X|^2. Allocated once for
+ * WF_FFT_MAX_SIZE, so size changes never touch them. */
+typedef struct {
+    kiss_fft_cpx *scratch;  /* WF_FFT_SCRATCH_SIZE(WF_FFT_MAX_SIZE) */
+    kiss_fft_cpx *out;      /* WF_FFT_MAX_SIZE */
+} fft_worker_t;
+
+static int g_fft_threads = 0;   /* 0 = auto (CPU count) */
+static wf_pool_t *g_fft_pool = NULL;
+static fft_worker_t *g_fft_workers = NULL;      /* Pool helpers + caller */
+static float *g_hop_power[MAX_PENDING_HOPS];
+
+/* Welch averaging (K periodograms per row) */
+static wf_welch_t g_welch;
+static int g_avg_frames = 1;
+static bool g_max_hold = false;
+
+/* Column-to-bin mapping (rebuilt on resize or FFT size change) */
+static wf_colmap_t g_colmap;
+static wf_pool_mode_t g_pool_mode = WF_POOL_MAX;
+
+/* Sliding DFT mode - one bin per column updated every sample; hop slots
+ * are filled at hop boundaries by push_display_sample */
+static bool g_sdft_mode = false;
+static wf_sdft_t g_sdft;
+
+/* I/Q buffer - mirrored double-length ring of IQ_RING_SIZE samples.
+ * Each sample is written at idx and idx + IQ_RING_SIZE, so the newest
+ * N samples (any N <= IQ_RING_SIZE) are always contiguous ending at
+ * g_iq_buffer + idx + IQ_RING_SIZE. Layout matches kiss_fft_cpx. */
 typedef struct { float i, q; } iq_sample_t;
 static iq_sample_t *g_iq_buffer = NULL;
 static int g_iq_buffer_idx = 0;
 static int g_new_samples = 0;
+static int g_iq_fill = 0;           /* Samples since the last zoom/pan change */
+
+/* Zoom - mixer + second decimation stage after the 12 kHz decimator.
+ * Level z narrows the span (and the decimated rate) by 2^z, so the same
+ * FFT size gives 2^z finer bins. Pan is the span center in Hz from DC. */
+static int g_zoom_level = 0;
+static float g_pan_hz = 0.0f;
+static bool g_zoom_ready = false;   /* Zoom decimators initialized */
+static pn_decimate_t g_zoom_dec_i;
+static pn_decimate_t g_zoom_dec_q;
+static float g_nco_r = 1.0f, g_nco_i = 0.0f;        /* Mixer phasor */
+static float g_nco_step_r = 1.0f, g_nco_step_i = 0.0f;
+static int g_nco_count = 0;
 
 /* Display */
-static float g_peak_db = -40.0f;
-static float g_floor_db = -80.0f;
 static float g_gain_offset = 0.0f;
-#define AGC_ATTACK  0.05f
-#define AGC_DECAY   0.002f
+static wf_palette_t g_palette;
+static wf_palette_id_t g_palette_id = WF_PALETTE_CLASSIC;
+
+/* Auto-gain - percentiles of each row's dB histogram, smoothed in time */
+#define AGC_FLOOR_PERCENTILE    0.20f
+#define AGC_PEAK_PERCENTILE     0.995f
+#define DEFAULT_AGC_ATTACK_S    0.4f    /* Range widening */
+#define DEFAULT_AGC_DECAY_S     10.0f   /* Range narrowing */
+static wf_agc_t g_agc;
+static float g_agc_attack_s = DEFAULT_AGC_ATTACK_S;
+static float g_agc_decay_s = DEFAULT_AGC_DECAY_S;
+
+/* Intensity history - 8-bit dB codes, one per pixel, in a ring of rows.
+ * Code c of a row means base_db[row] + c * HISTORY_DB_STEP, so any gain,
+ * palette or range change can recolor the whole screen. */
+#define HISTORY_DB_STEP         0.375f  /* 256 codes = 96 dB */
+#define HISTORY_BELOW_FLOOR_DB  16.0f   /* Code 0 relative to the AGC floor */
+#define HISTORY_EMPTY_DB        (-1000.0f)
+#define RECOLOR_AGC_DB          3.0f    /* AGC drift that triggers a recolor */
+static uint8_t *g_history = NULL;       /* g_history_height x g_history_width */
+static float *g_history_base = NULL;    /* dB of code 0, per history row */
+static int g_history_width = 0;         /* Geometry of the rows in g_history */
+static int g_history_height = 0;
+static int g_history_head = 0;          /* History row shown at the top */
+static size_t g_history_capacity = 0;
+static size_t g_history_base_capacity = 0;
+/* Resize target - swapped with g_history once the rows are resampled */
+static uint8_t *g_history_spare = NULL;
+static float *g_history_base_spare = NULL;
+static size_t g_history_spare_capacity = 0;
+static size_t g_history_base_spare_capacity = 0;
+static bool g_recolor_pending = false;
+static float g_view_floor_db = 0.0f;    /* AGC of the newest applied row */
+static float g_view_peak_db = 0.0f;
+static float g_view_row_seconds = 0.0f; /* Duration of the newest applied row */
+static float g_recolor_floor_db = 0.0f; /* AGC at the last full recolor */
+static float g_recolor_peak_db = 0.0f;
+
+/* Row queue - DSP thread to render thread, single producer and consumer.
+ * Each slot is one row of dB codes plus the AGC it was quantized under. */
+#define ROW_QUEUE_ROWS          512     /* Power of two */
+typedef struct {
+    uint8_t *codes;                     /* ROW_QUEUE_ROWS x width, then a spare row */
+    size_t capacity;                    /* Bytes allocated for codes */
+    float base_db[ROW_QUEUE_ROWS];
+    float floor_db[ROW_QUEUE_ROWS];
+    float peak_db[ROW_QUEUE_ROWS];
+    float seconds[ROW_QUEUE_ROWS];      /* Row duration (DSP-side rate and zoom) */
+    int width;
+    SDL_atomic_t head;                  /* Rows written (producer) */
+    SDL_atomic_t tail;                  /* Rows applied (consumer) */
+    unsigned dropped;
+} row_queue_t;
+static row_queue_t g_rowq;
+
+/* Per-bin noise floor flattening */
+#define FLATTEN_QUANTILE        0.25f
+#define FLATTEN_DB_PER_SECOND   2.0f    /* Max floor tracking speed */
+static wf_flatten_t g_flatten;
+static bool g_flatten_enabled = false;
 
 /* Settings panel */
 static bool g_show_settings = false;
 
+/* Frequency ruler (top) and row-age ticks (left), rasterized into two
+ * overlay textures only when center, span, row rate or size change */
+#define AXIS_RULER_HEIGHT       18
+#define AXIS_TIME_WIDTH         64
+#define AXIS_FREQ_SPACING       90      /* Min px between frequency labels */
+#define AXIS_TIME_SPACING       60      /* Min px between time labels */
+static bool g_axes_enabled = true;
+
+/* Spectrum trace panel above the waterfall: current, averaged and
+ * peak-hold dB per column, one polyline per trace */
+#define TRACE_HEIGHT            120     /* Panel height, px */
+#define TRACE_AVG_SECONDS       1.0f    /* Average time constant */
+#define TRACE_PEAK_DB_PER_SECOND 6.0f   /* Peak-hold decay */
+#define TRACE_MARGIN_DB         10.0f   /* Headroom around the AGC range */
+static bool g_trace_enabled = true;
+static wf_trace_t g_trace;
+static SDL_FPoint *g_trace_points = NULL;
+static size_t g_trace_points_capacity = 0;
+
+/* Scrollback: every row also goes to a memory-mapped store (with time
+ * mipmaps) at a fixed width. Pausing shows the store instead of the live
+ * ring; the view is one stored row per screen row at any depth. */
+#define STORE_COLUMNS           1024    /* Stored row width, pooled from the screen */
+#define STORE_LEVELS            12      /* Mips down to 1/2048 of the row rate */
+#define DEFAULT_STORE_MB        1024
+static char g_store_path[256] = "";     /* Empty = no store, no scrollback */
+static int g_store_mb = DEFAULT_STORE_MB;
+static wf_rowstore_t g_store;
+static bool g_store_open = false;
+static uint8_t g_store_row[STORE_COLUMNS];
+static bool g_scrollback = false;
+static uint64_t g_scroll_top = 0;       /* Level-0 index of the top row */
+static int g_scroll_level = 0;          /* 2^level rows per screen row */
+typedef struct {
+    uint64_t top_row;
+    int level;
+    int width, height, top;
+} scroll_state_t;
+static scroll_state_t g_scroll_state;
+static bool g_scroll_stale = true;      /* Colors or contents out of date */
+static SDL_Texture *g_scroll_texture = NULL;
+static int g_scroll_texture_width = 0;
+static int g_scroll_texture_height = 0;
+static uint32_t *g_scroll_pixels = NULL;
+#define SCROLL_SPAN_MARK        0xFF00D9FF  /* ARGB tick where the stored span changes */
+#define SCROLL_SPAN_MARK_WIDTH  12          /* px, at the right edge */
+static size_t g_scroll_pixels_capacity = 0;
+static uint8_t *g_scroll_codes = NULL;
+static size_t g_scroll_codes_capacity = 0;
+
+/* Headless: no window or renderer. Rows are colorized as usual and handed
+ * to a background encoder - snapshots of the whole history, or every row. */
+#define DEFAULT_SNAPSHOT_S      10.0f
+static bool g_headless = false;
+static char g_output_path[256] = "-";   /* "-" = stdout */
+static wf_encoder_format_t g_output_format = WF_ENCODER_PPM;
+static float g_snapshot_interval_s = DEFAULT_SNAPSHOT_S;
+static wf_encoder_t *g_encoder = NULL;
+
 #ifdef HAS_GUI
 static ui_core_t *g_ui = NULL;
 static widget_input_t g_input_host;
 static widget_input_t g_input_port;
 static widget_slider_t g_slider_gain;
+static widget_input_t g_input_fft_size;
+static widget_input_t g_input_fft_hop;
+static widget_slider_t g_slider_avg;
 static widget_button_t g_btn_connect;
+
+/* Panel is composed into a target texture, rebuilt only when its state
+ * (widgets, link status, cursor blink) differs from the last compose.
+ * Widgets are laid out in panel-local coordinates. */
+typedef struct {
+    widget_input_t host, port, fft_size, fft_hop;
+    widget_slider_t gain, avg;
+    widget_button_t connect;
+    bool connected;
+    bool cursor_on;
+} panel_state_t;
+static SDL_Texture *g_panel_texture = NULL;
+static panel_state_t g_panel_state;     /* State of the last compose */
+static bool g_panel_stale = true;
+
+typedef struct {
+    bool enabled;
+    wf_rowstore_span_t span;            /* Live span, or the top stored row's */
+    int width, height;
+    int top;                            /* First waterfall row on screen */
+    float start_seconds;                /* Age of the top row (scrollback) */
+    float row_seconds;
+} axis_state_t;
+static SDL_Texture *g_axis_freq_texture = NULL;
+static SDL_Texture *g_axis_time_texture = NULL;
+static axis_state_t g_axis_state;       /* State of the last compose */
+static int g_axis_center_serial = -1;
+static uint64_t g_axis_center_hz = 0;
+static bool g_axis_stale = true;
 #endif
 
 /*============================================================================
  * Config File
  *============================================================================*/
 
+/* Unknown engine names (CLI or ini) are reported and fall back to auto */
+static wf_fft_engine_t parse_fft_engine(const char *name) {
+    wf_fft_engine_t engine = wf_fft_engine_from_name(name);
+    if (engine != WF_FFT_ENGINE_COUNT) return engine;
+    fprintf(stderr, "Unknown FFT engine '%s' (auto", name);
+    for (int e = 0; e < WF_FFT_ENGINE_COUNT; e++) {
+        fprintf(stderr, ", %s", wf_fft_engine_name((wf_fft_engine_t)e));
+    }
+    fprintf(stderr, "), using auto\n");
+    return WF_FFT_ENGINE_AUTO;
+}
+
 static void load_config(void) {
     FILE *f = fopen(CONFIG_FILE, "r");
     if (!f) return;
@@ -245,6 +534,44 @@ static void load_config(void) {
                 if (g_window_height < MIN_WINDOW_HEIGHT) g_window_height = MIN_WINDOW_HEIGHT;
             } else if (strcmp(key, "gain") == 0) {
                 g_gain_offset = (float)atof(value);
+            } else if (strcmp(key, "agc_attack") == 0) {
+                g_agc_attack_s = (float)atof(value);
+            } else if (strcmp(key, "agc_decay") == 0) {
+                g_agc_decay_s = (float)atof(value);
+            } else if (strcmp(key, "flatten") == 0) {
+                g_flatten_enabled = atoi(value) != 0;
+            } else if (strcmp(key, "axes") == 0) {
+                g_axes_enabled = atoi(value) != 0;
+            } else if (strcmp(key, "trace") == 0) {
+                g_trace_enabled = atoi(value) != 0;
+            } else if (strcmp(key, "store") == 0) {
+                strncpy(g_store_path, value, sizeof(g_store_path) - 1);
+            } else if (strcmp(key, "store_mb") == 0) {
+                g_store_mb = atoi(value);
+            } else if (strcmp(key, "palette") == 0) {
+                g_palette_id = wf_palette_from_name(value);
+            } else if (strcmp(key, "fft_size") == 0) {
+                g_fft_size = atoi(value);
+            } else if (strcmp(key, "fft_hop") == 0) {
+                g_fft_hop = atoi(value);
+            } else if (strcmp(key, "fft_engine") == 0) {
+                g_fft_engine = parse_fft_engine(value);
+            } else if (strcmp(key, "fft_threads") == 0) {
+                g_fft_threads = atoi(value);
+            } else if (strcmp(key, "fixed_point") == 0) {
+                g_fixed_point = atoi(value) != 0;
+            } else if (strcmp(key, "avg") == 0) {
+                g_avg_frames = atoi(value);
+            } else if (strcmp(key, "max_hold") == 0) {
+                g_max_hold = atoi(value) != 0;
+            } else if (strcmp(key, "spectrum") == 0) {
+                g_sdft_mode = strcmp(value, "sdft") == 0;
+            } else if (strcmp(key, "pool") == 0) {
+                g_pool_mode = (strcmp(value, "mean") == 0) ? WF_POOL_MEAN : WF_POOL_MAX;
+            } else if (strcmp(key, "zoom") == 0) {
+                g_zoom_level = atoi(value);
+            } else if (strcmp(key, "pan") == 0) {
+                g_pan_hz = (float)atof(value);
             }
         }
     }
@@ -262,21 +589,246 @@ static void save_config(void) {
     fprintf(f, "width=%d\n", g_window_width);
     fprintf(f, "height=%d\n", g_window_height);
     fprintf(f, "gain=%.1f\n", g_gain_offset);
+    fprintf(f, "palette=%s\n", wf_palette_name(g_palette_id));
+    fprintf(f, "agc_attack=%.2f\n", g_agc_attack_s);
+    fprintf(f, "agc_decay=%.2f\n", g_agc_decay_s);
+    fprintf(f, "flatten=%d\n", g_flatten_enabled ? 1 : 0);
+    fprintf(f, "axes=%d\n", g_axes_enabled ? 1 : 0);
+    fprintf(f, "trace=%d\n", g_trace_enabled ? 1 : 0);
+    fprintf(f, "store=%s\n", g_store_path);
+    fprintf(f, "store_mb=%d\n", g_store_mb);
+    fprintf(f, "fft_size=%d\n", g_fft_size);
+    fprintf(f, "fft_hop=%d\n", g_fft_hop);
+    fprintf(f, "fft_engine=%s\n", wf_fft_engine_name(g_fft_engine));
+    fprintf(f, "fft_threads=%d\n", g_fft_threads);
+    fprintf(f, "fixed_point=%d\n", g_fixed_point ? 1 : 0);
+    fprintf(f, "avg=%d\n", g_avg_frames);
+    fprintf(f, "max_hold=%d\n", g_max_hold ? 1 : 0);
+    fprintf(f, "pool=%s\n", (g_pool_mode == WF_POOL_MEAN) ? "mean" : "max");
+    fprintf(f, "spectrum=%s\n", g_sdft_mode ? "sdft" : "fft");
+    fprintf(f, "zoom=%d\n", g_zoom_level);
+    fprintf(f, "pan=%.1f\n", g_pan_hz);
     fclose(f);
 }
 
 /*============================================================================
- * Window Function (Blackman-Harris)
- * Called once at startup - reduces spectral leakage in FFT
+ * Column Mapping
+ * Screen columns span ±(ZOOM_MAX_HZ / 2^zoom) around the pan center,
+ * which the mixer has already moved to DC
  *============================================================================*/
 
-static void generate_blackman_harris(float *window, int size) {
-    const float a0 = 0.35875f, a1 = 0.48829f, a2 = 0.14128f, a3 = 0.01168f;
-    const float pi = 3.14159265358979323846f;
-    for (int i = 0; i < size; i++) {
-        float n = (float)i / (float)(size - 1);
-        window[i] = a0 - a1*cosf(2*pi*n) + a2*cosf(4*pi*n) - a3*cosf(6*pi*n);
+static float zoom_half_span_hz(void) {
+    return ZOOM_MAX_HZ / (float)(1 << g_zoom_level);
+}
+
+static float zoom_sample_rate(void) {
+    return g_display_rate / (float)(1 << g_zoom_level);
+}
+
+static int zoom_hop(void);
+
+static bool rebuild_column_map(void) {
+    float half_span = zoom_half_span_hz();
+    if (!wf_colmap_build(&g_colmap, g_window_width, g_fft_size,
+                         zoom_sample_rate() / g_fft_size,
+                         -half_span, half_span, g_sdft_mode)) return false;
+    if (!g_sdft_mode) return true;
+
+    /* Re-seed tracked bins from the current history. Untracked entries of
+     * the hop slots are never read (nearest map) but must not hold NaNs. */
+    for (int h = 0; h < MAX_PENDING_HOPS; h++) {
+        memset(g_hop_power[h], 0, g_fft_size * sizeof(float));
+    }
+    g_new_samples = 0;
+    if (!wf_sdft_configure(&g_sdft, &g_colmap, g_fft_size,
+                           (const float*)(g_iq_buffer + g_iq_buffer_idx + IQ_RING_SIZE - g_fft_size))) {
+        return false;
+    }
+
+    /* Per sample: one complex multiply per tracked bin, against
+     * (N/2)log2(N) butterflies per hop for the FFT */
+    int log2n = 0;
+    while ((1 << log2n) < g_fft_size) log2n++;
+    int fft_cost = (g_fft_size / 2) * log2n / zoom_hop();
+    if (g_sdft.count > fft_cost) {
+        printf("Sliding DFT: %d bins per sample vs ~%d butterflies for the FFT at hop %d - "
+               "FFT mode is cheaper here\n", g_sdft.count, fft_cost, zoom_hop());
+    }
+    return true;
+}
+
+/*============================================================================
+ * Zoom / Pan
+ *============================================================================*/
+
+static void set_zoom(int level, float pan_hz) {
+    if (level < 0) level = 0;
+    if (level > ZOOM_MAX_LEVEL) level = ZOOM_MAX_LEVEL;
+
+    /* Keep the visible span inside the 12 kHz stream's clean passband */
+    float max_pan = ZOOM_MAX_HZ - ZOOM_MAX_HZ / (float)(1 << level);
+    if (pan_hz > max_pan) pan_hz = max_pan;
+    if (pan_hz < -max_pan) pan_hz = -max_pan;
+
+    bool level_changed = (level != g_zoom_level) || !g_zoom_ready;
+    bool pan_changed = pan_hz != g_pan_hz;
+    if (!level_changed && !pan_changed) return;
+    g_zoom_ready = true;
+    g_zoom_level = level;
+    g_pan_hz = pan_hz;
+
+    /* Mixer: multiply by exp(-j*2*pi*pan*t) to move pan to DC. Only the
+     * step changes; the phasor carries on, so the mixed stream stays
+     * continuous while panning. */
+    double w = -2.0 * 3.14159265358979323846 * pan_hz / g_display_rate;
+    g_nco_step_r = (float)cos(w);
+    g_nco_step_i = (float)sin(w);
+    if (!level_changed) return;         /* Ring and decimator history stay valid */
+
+    /* Samples already in the ring (and the decimator taps) were taken at
+     * the old rate. Start over rather than show rows whose windows mix the
+     * two; rows resume after fft_size new samples. */
+    g_nco_r = 1.0f;
+    g_nco_i = 0.0f;
+    g_nco_count = 0;
+    int factor = 1 << level;
+    pn_decimate_init(&g_zoom_dec_i, factor, g_display_rate);
+    pn_decimate_init(&g_zoom_dec_q, factor, g_display_rate);
+    memset(g_iq_buffer, 0, 2 * IQ_RING_SIZE * sizeof(iq_sample_t));
+    g_new_samples = 0;
+    g_iq_fill = 0;
+    wf_welch_configure(&g_welch, g_fft_size, g_avg_frames, g_max_hold);
+    wf_flatten_reset(&g_flatten);
+    rebuild_column_map();               /* Also re-seeds the sliding DFT */
+
+    printf("Zoom: %dx, span %.0f Hz, %.3f Hz/bin\n", factor,
+           2.0f * zoom_half_span_hz(), zoom_sample_rate() / g_fft_size);
+}
+
+/* Zoom by delta levels keeping the frequency under column x fixed */
+static void zoom_at_column(int delta, int x) {
+    float rel = (float)x / (float)g_window_width - 0.5f;
+    float freq = g_pan_hz + rel * 2.0f * zoom_half_span_hz();
+    int level = g_zoom_level + delta;
+    if (level < 0) level = 0;
+    if (level > ZOOM_MAX_LEVEL) level = ZOOM_MAX_LEVEL;
+    float new_half = ZOOM_MAX_HZ / (float)(1 << level);
+    set_zoom(level, freq - rel * 2.0f * new_half);
+}
+
+/* Hop in zoomed samples - keeps the row rate constant in time as zoom
+ * lowers the sample rate (FFT overlap grows instead) */
+static int zoom_hop(void) {
+    int hop = g_fft_hop >> g_zoom_level;
+    return (hop < 1) ? 1 : hop;
+}
+
+/* HOT PATH - per 12 kHz sample: mix, zoom-decimate, push to I/Q ring */
+static void push_display_sample(float i, float q) {
+    if (g_pan_hz != 0.0f) {
+        float mi = i * g_nco_r - q * g_nco_i;
+        float mq = i * g_nco_i + q * g_nco_r;
+        i = mi;
+        q = mq;
+        float nr = g_nco_r * g_nco_step_r - g_nco_i * g_nco_step_i;
+        float ni = g_nco_r * g_nco_step_i + g_nco_i * g_nco_step_r;
+        g_nco_r = nr;
+        g_nco_i = ni;
+        if (++g_nco_count == 1024) {
+            /* Renormalize so rounding can't grow/shrink the phasor */
+            float mag = sqrtf(g_nco_r * g_nco_r + g_nco_i * g_nco_i);
+            g_nco_r /= mag;
+            g_nco_i /= mag;
+            g_nco_count = 0;
+        }
+    }
+
+    if (g_zoom_level > 0) {
+        float zi, zq;
+        bool i_ready = pn_decimate_process(&g_zoom_dec_i, i, &zi);
+        bool q_ready = pn_decimate_process(&g_zoom_dec_q, q, &zq);
+        if (!(i_ready && q_ready)) return;
+        i = zi;
+        q = zq;
+    }
+
+    iq_sample_t *slot = &g_iq_buffer[g_iq_buffer_idx];
+    if (g_sdft_mode) {
+        /* Sample leaving the N-point window */
+        const iq_sample_t *old = slot + IQ_RING_SIZE - g_fft_size;
+        wf_sdft_update(&g_sdft, i, q, old->i, old->q);
+    }
+    slot->i = i;
+    slot->q = q;
+    slot[IQ_RING_SIZE] = *slot;  /* Mirror copy */
+    if (++g_iq_buffer_idx == IQ_RING_SIZE) g_iq_buffer_idx = 0;
+    g_new_samples++;
+    if (g_iq_fill < IQ_RING_SIZE) g_iq_fill++;
+
+    if (g_sdft_mode) {
+        int hop = zoom_hop();
+        if (g_new_samples % hop == 0) {
+            int h = g_new_samples / hop;
+            wf_sdft_power(&g_sdft, g_hop_power[(h - 1) % MAX_PENDING_HOPS]);
+        }
+    }
+}
+
+/*============================================================================
+ * FFT Size / Hop Selection
+ * Plans come from the wf_fft cache - switching sizes never reallocates
+ * the I/Q history, worker or hop buffers (all sized for WF_FFT_MAX_SIZE).
+ *============================================================================*/
+
+/* Per-worker and per-hop buffers for the largest size (startup only) */
+static bool alloc_fft_buffers(void) {
+    for (int w = 0; w <= wf_pool_workers(g_fft_pool); w++) {
+        g_fft_workers[w].scratch = (kiss_fft_cpx*)malloc(WF_FFT_SCRATCH_SIZE(WF_FFT_MAX_SIZE) * sizeof(kiss_fft_cpx));
+        g_fft_workers[w].out = (kiss_fft_cpx*)malloc(WF_FFT_MAX_SIZE * sizeof(kiss_fft_cpx));
+        if (!g_fft_workers[w].scratch || !g_fft_workers[w].out) return false;
+    }
+    for (int h = 0; h < MAX_PENDING_HOPS; h++) {
+        g_hop_power[h] = (float*)malloc(WF_FFT_MAX_SIZE * sizeof(float));
+        if (!g_hop_power[h]) return false;
+    }
+    return true;
+}
+
+static bool set_fft_params(int size, int hop) {
+    const wf_fft_plan_t *plan = wf_fft_get_plan(size);
+    if (!plan) {
+        printf("Invalid FFT size %d (power of two, %d-%d)\n", size, WF_FFT_MIN_SIZE, WF_FFT_MAX_SIZE);
+        return false;
+    }
+    if (hop < 1) hop = 1;
+    if (hop > WF_FFT_MAX_SIZE) hop = WF_FFT_MAX_SIZE;
+
+    if (plan != g_fft_plan || hop != g_fft_hop) {
+        printf("FFT: %d points (%.2f Hz/bin), hop %d (%.1f rows/s)\n", size,
+               zoom_sample_rate() / size, hop, g_display_rate / hop);
     }
+    g_fft_plan = plan;
+    g_fft_size = size;
+    g_fft_hop = hop;
+    wf_welch_configure(&g_welch, g_fft_size, g_avg_frames, g_max_hold);
+    return rebuild_column_map();
+}
+
+static bool set_spectrum_mode(bool sdft) {
+    g_sdft_mode = sdft;
+    wf_welch_configure(&g_welch, g_fft_size, g_avg_frames, g_max_hold);
+    wf_flatten_reset(&g_flatten);
+    g_new_samples = 0;
+    printf("Spectrum: %s\n", sdft ? "sliding DFT (on-screen bins, per sample)" : "FFT per hop");
+    return rebuild_column_map();
+}
+
+static void set_averaging(int frames, bool max_hold) {
+    if (frames < 1) frames = 1;
+    if (frames > WF_WELCH_MAX_FRAMES) frames = WF_WELCH_MAX_FRAMES;
+    g_avg_frames = frames;
+    g_max_hold = max_hold;
+    wf_welch_configure(&g_welch, g_fft_size, g_avg_frames, g_max_hold);
 }
 
 /*============================================================================
@@ -353,11 +905,26 @@ static void disconnect_from_relay(void) {
     g_last_reconnect_time = SDL_GetTicks();  /* Record disconnect time for retry */
 }
 
+/* DSP thread - the frequency ruler picks the change up on its next frame */
+static void set_center_freq(uint64_t hz) {
+    SDL_LockMutex(g_dsp_lock);
+    g_center_freq_hz = hz;
+    SDL_UnlockMutex(g_dsp_lock);
+    SDL_AtomicAdd(&g_center_serial, 1);
+}
+
+/* DSP thread - the UI may be editing the host/port fields */
 static bool connect_to_relay(void) {
     if (g_connected) return true;
 
-    printf("Connecting to %s:%d...\n", g_relay_host, g_relay_port);
-    g_socket = tcp_connect(g_relay_host, g_relay_port);
+    char host[sizeof(g_relay_host)];
+    SDL_LockMutex(g_dsp_lock);
+    memcpy(host, g_relay_host, sizeof(host));
+    int port = g_relay_port;
+    SDL_UnlockMutex(g_dsp_lock);
+
+    printf("Connecting to %s:%d...\n", host, port);
+    g_socket = tcp_connect(host, port);
     if (g_socket == SOCKET_INVALID) {
         printf("Connection failed\n");
         g_last_reconnect_time = SDL_GetTicks();
@@ -394,6 +961,7 @@ static bool connect_to_relay(void) {
     g_sample_rate = header.sample_rate;
     g_sample_format = header.sample_format;
     g_last_sequence = 0;  /* Reset sequence tracking */
+    set_center_freq(((uint64_t)header.center_freq_hi << 32) | header.center_freq_lo);
 
     const char *format_str = (g_sample_format == SAMPLE_FORMAT_S16) ? "S16" :
                             (g_sample_format == SAMPLE_FORMAT_F32) ? "F32" :
@@ -403,11 +971,44 @@ static bool connect_to_relay(void) {
     /* Initialize decimation (e.g., 2 MHz → 12 kHz = factor ~167) */
     int decimation_factor = g_sample_rate / DISPLAY_SAMPLE_RATE;
     if (decimation_factor < 1) decimation_factor = 1;
-    printf("Decimation: %d:1 (%u Hz → %u Hz)\n", decimation_factor, g_sample_rate, DISPLAY_SAMPLE_RATE);
     
     pn_decimate_init(&g_decimator_i, decimation_factor, (float)g_sample_rate);
     pn_decimate_init(&g_decimator_q, decimation_factor, (float)g_sample_rate);
 
+    g_q15_active = false;
+    if (g_fixed_point && (g_sample_format == SAMPLE_FORMAT_S16 || g_sample_format == SAMPLE_FORMAT_U8)) {
+        int bits = (g_sample_format == SAMPLE_FORMAT_S16) ? 16 : 9;
+        g_q15_active = wf_q15_decim_init(&g_q15_decim, decimation_factor, bits);
+        if (!g_q15_active) {
+            printf("Fixed-point decimation unavailable for %d:1, using float\n", decimation_factor);
+        }
+    }
+
+    /* Neither decimator hits 12 kHz exactly (2 MSPS: float 166:1, Q15
+     * 168:1), so bins, rows and the axis follow the rate actually produced */
+    float display_rate;
+    if (g_q15_active) {
+        display_rate = (float)g_sample_rate / (float)g_q15_decim.factor;
+        printf("Fixed-point decimation: CIC %d:1 x FIR %d:1 (%u Hz → %.0f Hz)\n",
+               g_q15_decim.cic_factor, WF_Q15_FIR_DECIM, g_sample_rate, display_rate);
+    } else {
+        display_rate = (float)g_sample_rate / (float)decimation_factor;
+        printf("Decimation: %d:1 (%u Hz → %.0f Hz)\n", decimation_factor, g_sample_rate, display_rate);
+    }
+
+    /* The q15 engine only pays off behind the Q15 front end; an explicit
+     * --fft-engine always wins */
+    wf_fft_engine_t engine = g_fft_engine;
+    if (g_q15_active && engine == WF_FFT_ENGINE_AUTO) engine = WF_FFT_ENGINE_Q15;
+
+    SDL_LockMutex(g_dsp_lock);
+    g_display_rate = display_rate;
+    wf_fft_set_engine(engine);
+    set_fft_params(g_fft_size, g_fft_hop);     /* Re-fetch a rebuilt plan */
+    g_zoom_ready = false;                       /* Re-derive mixer, zoom and columns */
+    set_zoom(g_zoom_level, g_pan_hz);
+    SDL_UnlockMutex(g_dsp_lock);
+
 #ifdef _WIN32
     timeout = 100;
     setsockopt(g_socket, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
@@ -420,51 +1021,399 @@ static bool connect_to_relay(void) {
     return true;
 }
 
+/* Render thread - the DSP thread performs it between frames */
+static void request_link(int request) {
+    SDL_AtomicSet(&g_link_request, request);
+}
+
 /*============================================================================
  * Window/Buffer Management
  *============================================================================*/
 
+static void recolor_history(void);
+
+/* Grow buf to at least need bytes, by half again its capacity or more, so
+ * a run of slightly larger sizes costs a few reallocations. Contents are
+ * kept. Returns NULL (buf still valid) on failure. */
+static void *grow_buffer(void *buf, size_t *capacity, size_t need) {
+    if (need <= *capacity) return buf;
+    size_t cap = *capacity + *capacity / 2;
+    if (cap < need) cap = need;
+    void *p = realloc(buf, cap);
+    if (!p) return NULL;
+    *capacity = cap;
+    return p;
+}
+
+/* Max-pool (shrinking) or repeat (growing) one row of codes to out_width.
+ * Codes of one row share a base, so pooling them needs no conversion. */
+static void pool_columns(const uint8_t *in, int in_width, uint8_t *out, int out_width) {
+    for (int c = 0; c < out_width; c++) {
+        int x0 = (int)((int64_t)c * in_width / out_width);
+        int x1 = (int)((int64_t)(c + 1) * in_width / out_width);
+        uint8_t m = in[x0];
+        for (int x = x0 + 1; x < x1; x++) m = (in[x] > m) ? in[x] : m;
+        out[c] = m;
+    }
+}
+
+/* Rows keep their age (one row per pixel in time); columns cover the same
+ * span, so they are pooled. The result has the newest row at index 0. */
+static void resample_history(uint8_t *dst, float *dst_base, int width, int height) {
+    int old_w = g_history_width;
+    int old_h = g_history_height;
+    for (int age = 0; age < height; age++) {
+        uint8_t *out = dst + (size_t)age * width;
+        if (age >= old_h) {
+            memset(out, 0, width);
+            dst_base[age] = HISTORY_EMPTY_DB;
+            continue;
+        }
+        int r = (g_history_head + age) % old_h;
+        const uint8_t *in = g_history + (size_t)r * old_w;
+        dst_base[age] = g_history_base[r];
+        pool_columns(in, old_w, out, width);
+    }
+}
+
+/* Adopt g_window_width x g_window_height. Buffers only ever grow, and the
+ * texture is allocated with headroom, so shrinking or nudging the window
+ * reuses everything. The history survives, resampled. */
 static bool resize_buffers(void) {
-    free(g_pixels);
-    g_pixels = (uint8_t*)calloc(g_window_width * g_window_height * 3, 1);
-    if (!g_pixels) return false;
+    int width = g_window_width;
+    int height = g_window_height;
+    size_t cells = (size_t)width * height;
+
+    uint8_t *codes = (uint8_t*)grow_buffer(g_history_spare, &g_history_spare_capacity, cells);
+    if (!codes) return false;
+    g_history_spare = codes;
+    float *base = (float*)grow_buffer(g_history_base_spare, &g_history_base_spare_capacity,
+                                      height * sizeof(float));
+    if (!base) return false;
+    g_history_base_spare = base;
+
+    resample_history(codes, base, width, height);
+    g_history_spare = g_history;
+    g_history_base_spare = g_history_base;
+    g_history = codes;
+    g_history_base = base;
+    size_t cap = g_history_capacity;
+    g_history_capacity = g_history_spare_capacity;
+    g_history_spare_capacity = cap;
+    cap = g_history_base_capacity;
+    g_history_base_capacity = g_history_base_spare_capacity;
+    g_history_base_spare_capacity = cap;
+    g_history_width = width;
+    g_history_height = height;
+    g_history_head = 0;
+
+    uint32_t *pixels = (uint32_t*)grow_buffer(g_pixels, &g_pixels_capacity,
+                                              cells * sizeof(uint32_t));
+    if (!pixels) return false;
+    g_pixels = pixels;
+
+    /* Queued rows have the old width - drop them (DSP thread is locked out) */
+    uint8_t *queue = (uint8_t*)grow_buffer(g_rowq.codes, &g_rowq.capacity,
+                                           (size_t)(ROW_QUEUE_ROWS + 1) * width);
+    if (!queue) return false;
+    g_rowq.codes = queue;
+    g_rowq.width = width;
+    SDL_AtomicSet(&g_rowq.head, 0);
+    SDL_AtomicSet(&g_rowq.tail, 0);
+
+    SDL_FPoint *points = (SDL_FPoint*)grow_buffer(g_trace_points, &g_trace_points_capacity,
+                                                  width * sizeof(SDL_FPoint));
+    if (!points) return false;
+    g_trace_points = points;
+    if (!wf_trace_resize(&g_trace, width)) return false;
+
+    if (!rebuild_column_map()) return false;
+
+    if (g_renderer && (!g_texture || width > g_texture_width || height > g_texture_height)) {
+        int tex_w = (width > g_texture_width) ? width + width / 4 : g_texture_width;
+        int tex_h = (height > g_texture_height) ? height + height / 4 : g_texture_height;
+        if (g_max_texture_width > 0 && tex_w > g_max_texture_width) tex_w = g_max_texture_width;
+        if (g_max_texture_height > 0 && tex_h > g_max_texture_height) tex_h = g_max_texture_height;
+        if (tex_w < width) tex_w = width;
+        if (tex_h < height) tex_h = height;
+        if (g_texture) SDL_DestroyTexture(g_texture);
+        g_texture = SDL_CreateTexture(g_renderer, SDL_PIXELFORMAT_ARGB8888,
+                                      SDL_TEXTUREACCESS_STREAMING, tex_w, tex_h);
+        if (!g_texture) return false;
+        g_texture_width = tex_w;
+        g_texture_height = tex_h;
+    }
 
-    free(g_magnitudes);
-    g_magnitudes = (float*)malloc(g_window_width * sizeof(float));
-    if (!g_magnitudes) return false;
+    recolor_history();
+    return true;
+}
 
-    if (g_texture) SDL_DestroyTexture(g_texture);
-    g_texture = SDL_CreateTexture(g_renderer, SDL_PIXELFORMAT_RGB24,
-                                   SDL_TEXTUREACCESS_STREAMING,
-                                   g_window_width, g_window_height);
-    return g_texture != NULL;
+/* Write the config once settings have stopped changing */
+static void schedule_config_save(void) {
+    g_config_dirty = true;
+    g_config_due = SDL_GetTicks() + CONFIG_SAVE_DELAY_MS;
+}
+
+/* First screen row of the waterfall (the trace panel sits above it) */
+static int waterfall_top(void) {
+    return g_trace_enabled ? TRACE_HEIGHT : 0;
+}
+
+/* Wall-clock time covered by one row: hop * K samples at the zoomed rate */
+static float row_seconds(void) {
+    return (float)(zoom_hop() << g_zoom_level) * g_avg_frames / g_display_rate;
 }
 
 /*============================================================================
- * Color Mapping (HOT PATH - called per pixel)
- * Converts magnitude to RGB using blue→cyan→green→yellow→red gradient
+ * Row Kernel (HOT PATH - once per row, DSP thread)
+ * Pool → dB → histogram → quantize fused into one pass over the columns.
+ * Work is done in ROW_BLOCK-column chunks so the temporaries stay in L1
+ * and each stage is a straight vectorizable loop. The row leaves as 8-bit
+ * dB codes; the render thread colorizes them with the AGC state from the
+ * previous row (the AGC is updated after).
  *============================================================================*/
 
-static void magnitude_to_rgb(float mag, float peak_db, float floor_db,
-                              uint8_t *r, uint8_t *g, uint8_t *b) {
-    float db = 20.0f * log10f(mag + 1e-10f) + g_gain_offset;
-    float range = peak_db - floor_db;
+#define ROW_BLOCK 256
+
+static void process_row(const float *power, int fft_size, uint8_t *codes, float *base_db) {
+    float pooled[ROW_BLOCK];
+    float db[ROW_BLOCK];
+    const float norm_db = -20.0f * log10f((float)fft_size);  /* |X|/N in dB */
+
+    /* Code 0 sits a fixed margin below the current floor */
+    const float base = g_agc.floor_db - HISTORY_BELOW_FLOOR_DB;
+    const float inv_step = 1.0f / HISTORY_DB_STEP;
+    *base_db = base;
+
+    for (int c0 = 0; c0 < g_window_width; c0 += ROW_BLOCK) {
+        int n = g_window_width - c0;
+        if (n > ROW_BLOCK) n = ROW_BLOCK;
+
+        wf_colmap_apply(&g_colmap, power, g_pool_mode, c0, n, pooled);
+        wf_power_to_db(pooled, db, n, norm_db);
+
+        wf_agc_accumulate(&g_agc, db, n);
+
+        uint8_t *restrict dst = codes + c0;
+        for (int i = 0; i < n; i++) {
+            float v = (db[i] - base) * inv_step + 0.5f;
+            v = (v < 0.0f) ? 0.0f : v;
+            v = (v > 255.0f) ? 255.0f : v;
+            dst[i] = (uint8_t)v;
+        }
+    }
+
+    /* Auto-Gain */
+    wf_agc_update(&g_agc, row_seconds());
+}
+
+/*============================================================================
+ * History Colorization (render thread)
+ *============================================================================*/
+
+/* Palette scale/offset for codes of a row whose code 0 is base_db */
+static void history_lut(float base_db, float *scale, float *offset) {
+    float range = g_view_peak_db - g_view_floor_db;
     if (range < 20.0f) range = 20.0f;
-    float norm = (db - floor_db) / range;
-    if (norm < 0.0f) norm = 0.0f;
-    if (norm > 1.0f) norm = 1.0f;
-
-    if (norm < 0.25f) {
-        *r = 0; *g = 0; *b = (uint8_t)(norm * 4.0f * 255.0f);
-    } else if (norm < 0.5f) {
-        *r = 0; *g = (uint8_t)((norm - 0.25f) * 4.0f * 255.0f); *b = 255;
-    } else if (norm < 0.75f) {
-        *r = (uint8_t)((norm - 0.5f) * 4.0f * 255.0f);
-        *g = 255;
-        *b = (uint8_t)((0.75f - norm) * 4.0f * 255.0f);
-    } else {
-        *r = 255; *g = (uint8_t)((1.0f - norm) * 4.0f * 255.0f); *b = 0;
+    float lut_scale, lut_offset;
+    wf_palette_scale(g_view_floor_db, range, g_gain_offset, &lut_scale, &lut_offset);
+    *scale = lut_scale * HISTORY_DB_STEP;
+    *offset = base_db * lut_scale + lut_offset;
+}
+
+/* Move up to max_rows queued rows into the history ring and colorize them */
+static int apply_queued_rows(int max_rows) {
+    unsigned tail = (unsigned)SDL_AtomicGet(&g_rowq.tail);
+    unsigned head = (unsigned)SDL_AtomicGet(&g_rowq.head);
+    if (head - tail > (unsigned)max_rows) head = tail + (unsigned)max_rows;
+    int rows = 0;
+
+    for (; tail != head; tail++) {
+        unsigned slot = tail % ROW_QUEUE_ROWS;
+        g_view_floor_db = g_rowq.floor_db[slot];
+        g_view_peak_db = g_rowq.peak_db[slot];
+        g_view_row_seconds = g_rowq.seconds[slot];
+
+        /* New row goes one ring slot above the current top; nothing else moves */
+        g_history_head = (g_history_head + g_window_height - 1) % g_window_height;
+        uint8_t *codes = g_history + (size_t)g_history_head * g_window_width;
+        memcpy(codes, g_rowq.codes + (size_t)slot * g_rowq.width, g_window_width);
+        g_history_base[g_history_head] = g_rowq.base_db[slot];
+
+        float scale, offset;
+        history_lut(g_rowq.base_db[slot], &scale, &offset);
+        wf_palette_map_codes_argb(&g_palette, codes, g_window_width, scale, offset,
+                                  g_pixels + (size_t)g_history_head * g_window_width);
+        if (g_trace_enabled) {
+            float dt = g_rowq.seconds[slot];
+            wf_trace_update(&g_trace, codes, g_rowq.base_db[slot], HISTORY_DB_STEP,
+                            1.0f - expf(-dt / TRACE_AVG_SECONDS),
+                            TRACE_PEAK_DB_PER_SECOND * dt);
+        }
+        g_dirty_rows++;
+        rows++;
+    }
+    SDL_AtomicSet(&g_rowq.tail, (int)tail);
+
+    /* Older rows were colored for a different range - recolor when the
+     * AGC has drifted far enough to be visible */
+    if (fabsf(g_view_floor_db - g_recolor_floor_db) > RECOLOR_AGC_DB ||
+        fabsf(g_view_peak_db - g_recolor_peak_db) > RECOLOR_AGC_DB) {
+        g_recolor_pending = true;
+    }
+    return rows;
+}
+
+/* Re-colorize every row from the history (gain, palette or range changed).
+ * Pixel rows share the history's ring indexing. */
+static void recolor_history(void) {
+    for (int h = 0; h < g_window_height; h++) {
+        float scale, offset;
+        history_lut(g_history_base[h], &scale, &offset);
+        wf_palette_map_codes_argb(&g_palette, g_history + (size_t)h * g_window_width,
+                                  g_window_width, scale, offset,
+                                  g_pixels + (size_t)h * g_window_width);
+    }
+    g_dirty_rows = g_window_height;
+    g_recolor_floor_db = g_view_floor_db;
+    g_recolor_peak_db = g_view_peak_db;
+    g_recolor_pending = false;
+    g_scroll_stale = true;
+}
+
+/*============================================================================
+ * Scrollback
+ * The view is anchored to an absolute row, so new rows don't move it; it
+ * is recomposed only when scrolled, rescaled, resized or recolored.
+ *============================================================================*/
+
+/* Rows appended since the top of the view */
+static uint64_t scroll_age_rows(void) {
+    SDL_LockMutex(g_dsp_lock);
+    uint64_t written = wf_rowstore_written(&g_store, 0);
+    SDL_UnlockMutex(g_dsp_lock);
+    return (written > g_scroll_top) ? written - 1 - g_scroll_top : 0;
+}
+
+/* Move the view by screen_rows (positive = older), kept inside what the
+ * current level still holds */
+static void scroll_history(int screen_rows) {
+    SDL_LockMutex(g_dsp_lock);
+    uint64_t written = wf_rowstore_written(&g_store, 0);
+    SDL_UnlockMutex(g_dsp_lock);
+    if (written == 0) return;
+
+    uint64_t held = (uint64_t)g_store.capacity << g_scroll_level;
+    int64_t oldest = (written > held) ? (int64_t)(written - held) : 0;
+    int64_t top = (int64_t)g_scroll_top - ((int64_t)screen_rows << g_scroll_level);
+    if (top < oldest) top = oldest;
+    if (top > (int64_t)written - 1) top = (int64_t)written - 1;
+    g_scroll_top = (uint64_t)top;
+
+    printf("Scrollback: %.1f min ago, %dx time\n",
+           (double)(written - 1 - g_scroll_top) * g_view_row_seconds / 60.0, 1 << g_scroll_level);
+}
+
+static void set_scrollback(bool on) {
+    if (!g_store_open) {
+        printf("Scrollback needs a row store (--store FILE)\n");
+        return;
+    }
+    if (on && !g_scrollback) {
+        SDL_LockMutex(g_dsp_lock);
+        uint64_t written = wf_rowstore_written(&g_store, 0);
+        SDL_UnlockMutex(g_dsp_lock);
+        g_scroll_top = (written > 0) ? written - 1 : 0;
+    }
+    g_scrollback = on;
+    printf("Scrollback: %s\n", on ? "paused" : "live");
+}
+
+static bool scrollback_changed(void) {
+    scroll_state_t state;
+    memset(&state, 0, sizeof(state));
+    state.top_row = g_scroll_top;
+    state.level = g_scroll_level;
+    state.width = g_window_width;
+    state.height = g_window_height;
+    state.top = waterfall_top();
+
+    if (memcmp(&state, &g_scroll_state, sizeof(state)) != 0) {
+        g_scroll_state = state;
+        g_scroll_stale = true;
+    }
+    return g_scroll_stale;
+}
+
+/* One stored row per screen row: level-L row j holds level-0 rows
+ * [j << L, (j + 1) << L), so screen row y is row (top >> L) - y */
+static bool compose_scrollback(int visible) {
+    uint32_t *pixels = (uint32_t*)grow_buffer(g_scroll_pixels, &g_scroll_pixels_capacity,
+                                              (size_t)g_window_width * visible * sizeof(uint32_t));
+    if (!pixels) return false;
+    g_scroll_pixels = pixels;
+    uint8_t *codes = (uint8_t*)grow_buffer(g_scroll_codes, &g_scroll_codes_capacity,
+                                           g_window_width);
+    if (!codes) return false;
+    g_scroll_codes = codes;
+
+    if (!g_scroll_texture || g_scroll_texture_width != g_texture_width ||
+        g_scroll_texture_height != g_texture_height) {
+        if (g_scroll_texture) SDL_DestroyTexture(g_scroll_texture);
+        g_scroll_texture = SDL_CreateTexture(g_renderer, SDL_PIXELFORMAT_ARGB8888,
+                                             SDL_TEXTUREACCESS_STREAMING,
+                                             g_texture_width, g_texture_height);
+        if (!g_scroll_texture) return false;
+        g_scroll_texture_width = g_texture_width;
+        g_scroll_texture_height = g_texture_height;
+    }
+
+    uint64_t newest = g_scroll_top >> g_scroll_level;
+    wf_rowstore_span_t span, prev_span;
+    bool have_prev = false;
+    SDL_LockMutex(g_dsp_lock);
+    for (int y = 0; y < visible; y++) {
+        float base = HISTORY_EMPTY_DB;
+        const uint8_t *row = ((uint64_t)y <= newest)
+            ? wf_rowstore_row(&g_store, g_scroll_level, newest - y, &base, &span) : NULL;
+        uint32_t *line = pixels + (size_t)y * g_window_width;
+
+        /* Span changed since the row above (zoom, pan or retune) */
+        bool boundary = row && have_prev && memcmp(&span, &prev_span, sizeof(span)) != 0;
+        if (row) {
+            prev_span = span;
+            have_prev = true;
+        }
+        if (row) {
+            pool_columns(row, STORE_COLUMNS, codes, g_window_width);
+        } else {
+            memset(codes, 0, g_window_width);
+            base = HISTORY_EMPTY_DB;
+        }
+        float scale, offset;
+        history_lut(base, &scale, &offset);
+        wf_palette_map_codes_argb(&g_palette, codes, g_window_width, scale, offset, line);
+        if (boundary) {
+            int mark = (g_window_width < SCROLL_SPAN_MARK_WIDTH) ? g_window_width : SCROLL_SPAN_MARK_WIDTH;
+            for (int x = g_window_width - mark; x < g_window_width; x++) line[x] = SCROLL_SPAN_MARK;
+        }
+    }
+    SDL_UnlockMutex(g_dsp_lock);
+
+    SDL_Rect rect = { 0, 0, g_window_width, visible };
+    SDL_UpdateTexture(g_scroll_texture, &rect, pixels, g_window_width * (int)sizeof(uint32_t));
+    return true;
+}
+
+static void render_scrollback(int top) {
+    int visible = g_window_height - top;
+    if (g_scroll_stale) {
+        if (!compose_scrollback(visible)) return;
+        g_scroll_stale = false;
     }
+    SDL_Rect src = { 0, 0, g_window_width, visible };
+    SDL_Rect dst = { 0, top, g_window_width, visible };
+    SDL_RenderCopy(g_renderer, g_scroll_texture, &src, &dst);
 }
 
 /*============================================================================
@@ -473,10 +1422,8 @@ static void magnitude_to_rgb(float mag, float peak_db, float floor_db,
 
 #ifdef HAS_GUI
 static void init_settings_panel(void) {
-    int panel_x = (g_window_width - PANEL_WIDTH) / 2;
-    int panel_y = (g_window_height - PANEL_HEIGHT) / 2;
-    int x = panel_x + 15;
-    int y = panel_y + 40;
+    int x = 15;
+    int y = 40;
 
     widget_input_init(&g_input_host, x, y, 220, 24, "Host", 64, false);
     widget_input_set_text(&g_input_host, g_relay_host);
@@ -493,12 +1440,40 @@ static void init_settings_panel(void) {
     g_slider_gain.format = "%+d dB";
     y += 45;
 
+    char num_str[16];
+    widget_input_init(&g_input_fft_size, x, y, 80, 24, "FFT size", 5, true);
+    snprintf(num_str, sizeof(num_str), "%d", g_fft_size);
+    widget_input_set_text(&g_input_fft_size, num_str);
+    widget_input_init(&g_input_fft_hop, x + 110, y, 80, 24, "Hop", 5, true);
+    snprintf(num_str, sizeof(num_str), "%d", g_fft_hop);
+    widget_input_set_text(&g_input_fft_hop, num_str);
+    y += 50;
+
+    widget_slider_init(&g_slider_avg, x, y, 220, 20, 1, 32, "Average (FFTs per row)");
+    g_slider_avg.value = g_avg_frames;
+    g_slider_avg.format = "x%d";
+    y += 45;
+
     widget_button_init(&g_btn_connect, x, y, 100, 28, "Connect");
 }
 
-static void update_settings_panel(mouse_state_t *mouse, SDL_Event *event) {
+static void sync_fft_inputs(void) {
+    char num_str[16];
+    snprintf(num_str, sizeof(num_str), "%d", g_fft_size);
+    widget_input_set_text(&g_input_fft_size, num_str);
+    snprintf(num_str, sizeof(num_str), "%d", g_fft_hop);
+    widget_input_set_text(&g_input_fft_hop, num_str);
+}
+
+static void update_settings_panel(const mouse_state_t *screen_mouse, SDL_Event *event) {
     if (!g_show_settings) return;
 
+    /* Widgets live in panel coordinates */
+    mouse_state_t local = *screen_mouse;
+    local.x -= (g_window_width - PANEL_WIDTH) / 2;
+    local.y -= (g_window_height - PANEL_HEIGHT) / 2;
+    const mouse_state_t *mouse = &local;
+
     /* Update widgets */
     if (widget_input_update(&g_input_host, mouse, event)) {
         strncpy(g_relay_host, g_input_host.text, sizeof(g_relay_host) - 1);
@@ -509,34 +1484,39 @@ static void update_settings_panel(mouse_state_t *mouse, SDL_Event *event) {
     }
     if (widget_slider_update(&g_slider_gain, mouse)) {
         g_gain_offset = (float)g_slider_gain.value;
+        g_recolor_pending = true;
+    }
+
+    /* FFT size/hop apply on Enter (intermediate keystrokes are not valid sizes) */
+    bool fft_size_changed = widget_input_update(&g_input_fft_size, mouse, event);
+    bool fft_hop_changed = widget_input_update(&g_input_fft_hop, mouse, event);
+    if ((fft_size_changed && !g_input_fft_size.focused) ||
+        (fft_hop_changed && !g_input_fft_hop.focused)) {
+        set_fft_params(atoi(g_input_fft_size.text), atoi(g_input_fft_hop.text));
+        sync_fft_inputs();
+        schedule_config_save();
+    }
+    if (widget_slider_update(&g_slider_avg, mouse)) {
+        set_averaging(g_slider_avg.value, g_max_hold);
     }
 
     if (widget_button_update(&g_btn_connect, mouse)) {
-        if (g_connected) {
-            disconnect_from_relay();
-        } else {
-            connect_to_relay();
-        }
-        save_config();
+        request_link(g_connected ? LINK_DISCONNECT : LINK_CONNECT);
+        schedule_config_save();
     }
 
     /* Update button labels */
     g_btn_connect.label = g_connected ? "Disconnect" : "Connect";
 }
 
-static void draw_settings_panel(void) {
-    if (!g_show_settings || !g_ui) return;
-
-    int panel_x = (g_window_width - PANEL_WIDTH) / 2;
-    int panel_y = (g_window_height - PANEL_HEIGHT) / 2;
-
+static void compose_settings_panel(void) {
     /* Panel background */
-    ui_draw_rect(g_ui, panel_x, panel_y, PANEL_WIDTH, PANEL_HEIGHT, COLOR_BG_PANEL);
-    ui_draw_rect_outline(g_ui, panel_x, panel_y, PANEL_WIDTH, PANEL_HEIGHT, COLOR_ACCENT_DIM);
+    ui_draw_rect(g_ui, 0, 0, PANEL_WIDTH, PANEL_HEIGHT, COLOR_BG_PANEL);
+    ui_draw_rect_outline(g_ui, 0, 0, PANEL_WIDTH, PANEL_HEIGHT, COLOR_ACCENT_DIM);
 
     /* Title */
     ui_draw_text_centered(g_ui, g_ui->font_large, "Settings",
-                          panel_x, panel_y + 10, PANEL_WIDTH, COLOR_ACCENT);
+                          0, 10, PANEL_WIDTH, COLOR_ACCENT);
 
     /* Status indicator */
     const char *status;
@@ -548,56 +1528,577 @@ static void draw_settings_panel(void) {
         status = "DISCONNECTED";
         status_color = COLOR_RED;
     }
-    ui_draw_text(g_ui, g_ui->font_small, status, panel_x + 15, panel_y + PANEL_HEIGHT - 25, status_color);
+    ui_draw_text(g_ui, g_ui->font_small, status, 15, PANEL_HEIGHT - 25, status_color);
 
     /* Draw widgets */
     widget_input_draw(&g_input_host, g_ui);
     widget_input_draw(&g_input_port, g_ui);
     widget_slider_draw(&g_slider_gain, g_ui);
+    widget_input_draw(&g_input_fft_size, g_ui);
+    widget_input_draw(&g_input_fft_hop, g_ui);
+    widget_slider_draw(&g_slider_avg, g_ui);
     widget_button_draw(&g_btn_connect, g_ui);
 }
 
-static void reposition_settings_panel(void) {
-    int panel_x = (g_window_width - PANEL_WIDTH) / 2;
-    int panel_y = (g_window_height - PANEL_HEIGHT) / 2;
-    int x = panel_x + 15;
-    int y = panel_y + 40;
+/* Snapshot the panel's visible state; true if it differs from the last
+ * compose (marks the cached texture stale) */
+static bool settings_panel_changed(void) {
+    panel_state_t state;
+    memset(&state, 0, sizeof(state));
+    state.host = g_input_host;
+    state.port = g_input_port;
+    state.fft_size = g_input_fft_size;
+    state.fft_hop = g_input_fft_hop;
+    state.gain = g_slider_gain;
+    state.avg = g_slider_avg;
+    state.connect = g_btn_connect;
+    state.connected = g_connected;
+    /* Same phase as the cursor blink in widget_input_draw */
+    bool focused = g_input_host.focused || g_input_port.focused ||
+                   g_input_fft_size.focused || g_input_fft_hop.focused;
+    state.cursor_on = focused && (SDL_GetTicks() / 500) % 2 == 0;
+
+    if (memcmp(&state, &g_panel_state, sizeof(state)) != 0) {
+        g_panel_state = state;
+        g_panel_stale = true;
+    }
+    return g_panel_stale;
+}
+
+static void draw_settings_panel(void) {
+    if (!g_show_settings || !g_ui) return;
+
+    SDL_Rect dst = {
+        (g_window_width - PANEL_WIDTH) / 2, (g_window_height - PANEL_HEIGHT) / 2,
+        PANEL_WIDTH, PANEL_HEIGHT
+    };
+
+    if (!g_panel_texture) {
+        g_panel_texture = SDL_CreateTexture(g_renderer, SDL_PIXELFORMAT_ARGB8888,
+                                            SDL_TEXTUREACCESS_TARGET, PANEL_WIDTH, PANEL_HEIGHT);
+        if (g_panel_texture) SDL_SetTextureBlendMode(g_panel_texture, SDL_BLENDMODE_BLEND);
+        g_panel_stale = true;
+    }
+
+    if (!g_panel_texture) {
+        /* No render targets - compose straight to the screen every frame */
+        SDL_RenderSetViewport(g_renderer, &dst);
+        compose_settings_panel();
+        SDL_RenderSetViewport(g_renderer, NULL);
+        return;
+    }
+
+    if (g_panel_stale) {
+        SDL_SetRenderTarget(g_renderer, g_panel_texture);
+        SDL_SetRenderDrawColor(g_renderer, 0, 0, 0, 0);
+        SDL_RenderClear(g_renderer);
+        compose_settings_panel();
+        SDL_SetRenderTarget(g_renderer, NULL);
+        g_panel_stale = false;
+    }
+    SDL_RenderCopy(g_renderer, g_panel_texture, NULL, &dst);
+}
+#endif
+
+/*============================================================================
+ * Axis Overlays
+ * Both rulers are composed into overlay textures that sit at the screen
+ * origin, so the same code draws into the texture or (without render
+ * targets) straight to the screen. Per frame they cost two copies.
+ *============================================================================*/
+
+#ifdef HAS_GUI
+static void compose_freq_ruler(void) {
+    const axis_state_t *a = &g_axis_state;
+    wf_axis_tick_t ticks[WF_AXIS_MAX_TICKS];
+    int n = wf_axis_freq_ticks(a->span.center_hz, a->span.left_hz, a->span.right_hz,
+                               a->width, AXIS_FREQ_SPACING, ticks);
+
+    ui_draw_rect(g_ui, 0, 0, a->width, AXIS_RULER_HEIGHT, 0x00000080);
+    for (int t = 0; t < n; t++) {
+        int w, h;
+        ui_get_text_size(g_ui, g_ui->font_small, ticks[t].label, &w, &h);
+        ui_draw_rect(g_ui, ticks[t].pos, AXIS_RULER_HEIGHT - 5, 1, 5, COLOR_ACCENT);
+        if (ticks[t].pos + 3 + w <= a->width) {
+            ui_draw_text(g_ui, g_ui->font_small, ticks[t].label, ticks[t].pos + 3, 2, COLOR_TEXT);
+        }
+    }
+}
+
+static void compose_time_ruler(void) {
+    const axis_state_t *a = &g_axis_state;
+    wf_axis_tick_t ticks[WF_AXIS_MAX_TICKS];
+    int n = wf_axis_time_ticks(a->start_seconds, a->row_seconds, a->height - a->top,
+                               AXIS_TIME_SPACING, ticks);
+
+    for (int t = 0; t < n; t++) {
+        int y = a->top + ticks[t].pos;
+        if (y < AXIS_RULER_HEIGHT + 8 || y + 8 > a->height) continue;
+        int w, h;
+        ui_get_text_size(g_ui, g_ui->font_small, ticks[t].label, &w, &h);
+        ui_draw_rect(g_ui, 0, y, 6, 1, COLOR_ACCENT);
+        ui_draw_rect(g_ui, 7, y - h / 2, w + 2, h, 0x000000A0);
+        ui_draw_text(g_ui, g_ui->font_small, ticks[t].label, 8, y - h / 2, COLOR_TEXT);
+    }
+}
+
+/* Snapshot what the rulers depend on; true if they need recomposing */
+static bool axis_overlay_changed(void) {
+    int serial = SDL_AtomicGet(&g_center_serial);
+    if (serial != g_axis_center_serial) {
+        SDL_LockMutex(g_dsp_lock);
+        g_axis_center_hz = g_center_freq_hz;
+        SDL_UnlockMutex(g_dsp_lock);
+        g_axis_center_serial = serial;
+    }
+
+    axis_state_t state;
+    memset(&state, 0, sizeof(state));
+    state.enabled = g_axes_enabled;
+    state.span.center_hz = (double)g_axis_center_hz;
+    state.span.left_hz = g_pan_hz - zoom_half_span_hz();
+    state.span.right_hz = g_pan_hz + zoom_half_span_hz();
+    state.width = g_window_width;
+    state.height = g_window_height;
+    state.top = waterfall_top();
+    state.row_seconds = g_view_row_seconds;
+    if (g_scrollback) {
+        state.start_seconds = (float)scroll_age_rows() * state.row_seconds;
+        state.row_seconds *= (float)(1 << g_scroll_level);
+        /* Label the span of the top row; compose_scrollback marks changes */
+        SDL_LockMutex(g_dsp_lock);
+        wf_rowstore_row(&g_store, g_scroll_level, g_scroll_top >> g_scroll_level, NULL, &state.span);
+        SDL_UnlockMutex(g_dsp_lock);
+    }
 
-    g_input_host.x = x; g_input_host.y = y; y += 50;
-    g_input_port.x = x; g_input_port.y = y; y += 50;
-    g_slider_gain.x = x; g_slider_gain.y = y; y += 45;
-    g_btn_connect.x = x; g_btn_connect.y = y;
+    if (memcmp(&state, &g_axis_state, sizeof(state)) != 0) {
+        g_axis_state = state;
+        g_axis_stale = true;
+    }
+    return g_axis_stale;
+}
+
+/* (Re)create an overlay texture of the given size; false if unsupported */
+static bool ensure_overlay(SDL_Texture **tex, int w, int h) {
+    int tw = 0, th = 0;
+    if (*tex && SDL_QueryTexture(*tex, NULL, NULL, &tw, &th) == 0 && tw == w && th == h) return true;
+    if (*tex) SDL_DestroyTexture(*tex);
+    *tex = SDL_CreateTexture(g_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, w, h);
+    if (!*tex) return false;
+    SDL_SetTextureBlendMode(*tex, SDL_BLENDMODE_BLEND);
+    g_axis_stale = true;
+    return true;
+}
+
+static void compose_overlay(SDL_Texture *tex, void (*compose)(void)) {
+    SDL_SetRenderTarget(g_renderer, tex);
+    SDL_SetRenderDrawColor(g_renderer, 0, 0, 0, 0);
+    SDL_RenderClear(g_renderer);
+    compose();
+    SDL_SetRenderTarget(g_renderer, NULL);
+}
+
+static void draw_axes(void) {
+    if (!g_axis_state.enabled || !g_ui) {
+        g_axis_stale = false;
+        return;
+    }
+
+    const axis_state_t *a = &g_axis_state;
+    if (!ensure_overlay(&g_axis_freq_texture, a->width, AXIS_RULER_HEIGHT) ||
+        !ensure_overlay(&g_axis_time_texture, AXIS_TIME_WIDTH, a->height)) {
+        /* No render targets - draw straight to the screen every frame */
+        compose_freq_ruler();
+        compose_time_ruler();
+        return;
+    }
+
+    if (g_axis_stale) {
+        compose_overlay(g_axis_freq_texture, compose_freq_ruler);
+        compose_overlay(g_axis_time_texture, compose_time_ruler);
+        g_axis_stale = false;
+    }
+    SDL_Rect freq_dst = { 0, 0, a->width, AXIS_RULER_HEIGHT };
+    SDL_Rect time_dst = { 0, 0, AXIS_TIME_WIDTH, a->height };
+    SDL_RenderCopy(g_renderer, g_axis_time_texture, NULL, &time_dst);
+    SDL_RenderCopy(g_renderer, g_axis_freq_texture, NULL, &freq_dst);
 }
 #endif
 
+/*============================================================================
+ * Waterfall Texture (ring of rows)
+ * The texture holds rows at the same ring index as g_history, so a new row
+ * touches only its own line. It is ARGB8888, the renderers' native layout,
+ * so uploads need no format conversion. Only rows written since the last
+ * frame are locked and copied, and the ring is presented as two copies
+ * split at the head.
+ *============================================================================*/
+
+static void upload_rows(int first, int count) {
+    SDL_Rect rect = { 0, first, g_window_width, count };
+    void *dst;
+    int pitch;
+    if (SDL_LockTexture(g_texture, &rect, &dst, &pitch) != 0) return;
+
+    const uint32_t *src = g_pixels + (size_t)first * g_window_width;
+    size_t row_bytes = (size_t)g_window_width * sizeof(uint32_t);
+    if ((size_t)pitch == row_bytes) {
+        memcpy(dst, src, row_bytes * count);
+    } else {
+        for (int y = 0; y < count; y++) {
+            memcpy((uint8_t*)dst + (size_t)y * pitch, src + (size_t)y * g_window_width, row_bytes);
+        }
+    }
+    SDL_UnlockTexture(g_texture);
+}
+
+static void upload_dirty_rows(void) {
+    int n = (g_dirty_rows < g_window_height) ? g_dirty_rows : g_window_height;
+    if (n <= 0) return;
+
+    /* Dirty rows are head .. head+n-1, wrapping at the bottom */
+    int first = g_history_head;
+    int run = g_window_height - first;
+    if (run > n) run = n;
+    upload_rows(first, run);
+    if (n > run) upload_rows(0, n - run);
+    g_dirty_rows = 0;
+}
+
+/* Ring rows head..H-1 are the newest, 0..head-1 the oldest. Below a
+ * trace panel only the newest H - top rows fit. */
+static void render_waterfall(int top) {
+    int visible = g_window_height - top;
+    int first = g_window_height - g_history_head;
+    if (first > visible) first = visible;
+    SDL_Rect src = { 0, g_history_head, g_window_width, first };
+    SDL_Rect dst = { 0, top, g_window_width, first };
+    SDL_RenderCopy(g_renderer, g_texture, &src, &dst);
+    if (visible > first) {
+        SDL_Rect src2 = { 0, 0, g_window_width, visible - first };
+        SDL_Rect dst2 = { 0, top + first, g_window_width, visible - first };
+        SDL_RenderCopy(g_renderer, g_texture, &src2, &dst2);
+    }
+}
+
+/*============================================================================
+ * Spectrum Trace Panel
+ * Traces are kept per column by apply_queued_rows; drawing is one
+ * SDL_RenderDrawLinesF call per trace.
+ *============================================================================*/
+
+static void draw_trace_line(const float *db, float lo_db, float px_per_db,
+                            uint8_t r, uint8_t g, uint8_t b) {
+    const float y_top = (float)AXIS_RULER_HEIGHT;
+    const float y_bottom = (float)(TRACE_HEIGHT - 1);
+    SDL_FPoint *restrict pts = g_trace_points;
+    for (int c = 0; c < g_trace.columns; c++) {
+        float y = y_bottom - (db[c] - lo_db) * px_per_db;
+        y = (y < y_top) ? y_top : y;
+        y = (y > y_bottom) ? y_bottom : y;
+        pts[c].x = (float)c;
+        pts[c].y = y;
+    }
+    SDL_SetRenderDrawColor(g_renderer, r, g, b, 255);
+    SDL_RenderDrawLinesF(g_renderer, pts, g_trace.columns);
+}
+
+static void draw_trace(void) {
+    SDL_Rect panel = { 0, 0, g_window_width, TRACE_HEIGHT };
+    SDL_SetRenderDrawColor(g_renderer, 0x10, 0x10, 0x20, 255);
+    SDL_RenderFillRect(g_renderer, &panel);
+    if (!g_trace.primed) return;
+
+    /* Same range the colors use, with some headroom */
+    float lo = g_view_floor_db - TRACE_MARGIN_DB;
+    float hi = g_view_peak_db;
+    if (hi < g_view_floor_db + 20.0f) hi = g_view_floor_db + 20.0f;
+    hi += TRACE_MARGIN_DB;
+    float px_per_db = (float)(TRACE_HEIGHT - 1 - AXIS_RULER_HEIGHT) / (hi - lo);
+
+    draw_trace_line(g_trace.peak, lo, px_per_db, 0xFF, 0x80, 0x40);
+    draw_trace_line(g_trace.average, lo, px_per_db, 0x00, 0xD9, 0xFF);
+    draw_trace_line(g_trace.current, lo, px_per_db, 0xE8, 0xE8, 0xE8);
+}
+
 /*============================================================================
  * Status Indicator (non-GUI fallback)
  *============================================================================*/
 
 static void draw_status_indicator(void) {
     int size = 12;
-    int x = g_window_width - size - 5;
-    int y = 5;
+    SDL_Rect rect = { g_window_width - size - 5, 5, size, size };
 
-    uint8_t r, g, b;
+    uint8_t r, g, b, a;
+    SDL_GetRenderDrawColor(g_renderer, &r, &g, &b, &a);
     if (g_connected) {
-        r = 0; g = 255; b = 0;
+        SDL_SetRenderDrawColor(g_renderer, 0, 255, 0, 255);
     } else {
-        r = 255; g = 0; b = 0;
-    }
-
-    for (int dy = 0; dy < size; dy++) {
-        for (int dx = 0; dx < size; dx++) {
-            int px = x + dx;
-            int py = y + dy;
-            if (px >= 0 && px < g_window_width && py >= 0 && py < g_window_height) {
-                int idx = (py * g_window_width + px) * 3;
-                g_pixels[idx] = r;
-                g_pixels[idx+1] = g;
-                g_pixels[idx+2] = b;
+        SDL_SetRenderDrawColor(g_renderer, 255, 0, 0, 255);
+    }
+    SDL_RenderFillRect(g_renderer, &rect);
+    SDL_SetRenderDrawColor(g_renderer, r, g, b, a);
+}
+
+/*============================================================================
+ * FFT Hop Processing (HOT PATH)
+ * Every complete hop since the last pass gets its own FFT. Windows are
+ * read straight from the mirrored history ring, so hops are independent
+ * and run concurrently on the pool; Welch and row drawing then consume the
+ * results strictly in hop order.
+ *============================================================================*/
+
+typedef struct {
+    const iq_sample_t *start[MAX_PENDING_HOPS];    /* Window start per hop */
+    int fft_size;
+} hop_batch_t;
+
+static void fft_hop_job(int job, int worker, void *ctx) {
+    const hop_batch_t *batch = (const hop_batch_t*)ctx;
+    fft_worker_t *fw = &g_fft_workers[worker];
+    wf_fft_execute(g_fft_plan, (const kiss_fft_cpx*)batch->start[job], fw->scratch, fw->out);
+    wf_fft_power(fw->out, g_hop_power[job], batch->fft_size);
+}
+
+/* Run the row kernel into the next queue slot */
+static void emit_row(void) {
+    float seconds = row_seconds();
+    if (g_flatten_enabled) {
+        wf_flatten_apply(&g_flatten, g_welch.power, g_welch.bins,
+                         FLATTEN_DB_PER_SECOND, seconds);
+    }
+
+    /* Render thread stalled (window hidden, dragged): the row still updates
+     * the AGC and goes to the store, quantized into the spare row */
+    unsigned head = (unsigned)SDL_AtomicGet(&g_rowq.head);
+    bool full = head - (unsigned)SDL_AtomicGet(&g_rowq.tail) >= ROW_QUEUE_ROWS;
+    unsigned slot = full ? ROW_QUEUE_ROWS : head % ROW_QUEUE_ROWS;
+    uint8_t *codes = g_rowq.codes + (size_t)slot * g_rowq.width;
+    float floor_db = g_agc.floor_db;
+    float peak_db = g_agc.peak_db;
+    float base_db;
+    process_row(g_welch.power, g_welch.bins, codes, &base_db);
+
+    if (g_store_open) {
+        wf_rowstore_span_t span = { (double)g_center_freq_hz,
+                                    g_pan_hz - zoom_half_span_hz(), g_pan_hz + zoom_half_span_hz() };
+        pool_columns(codes, g_rowq.width, g_store_row, STORE_COLUMNS);
+        wf_rowstore_append(&g_store, g_store_row, base_db, &span);
+    }
+
+    if (full) {
+        g_rowq.dropped++;
+        return;
+    }
+    g_rowq.base_db[slot] = base_db;
+    g_rowq.floor_db[slot] = floor_db;
+    g_rowq.peak_db[slot] = peak_db;
+    g_rowq.seconds[slot] = seconds;
+    SDL_AtomicSet(&g_rowq.head, (int)(head + 1));
+}
+
+/* Returns number of waterfall rows queued */
+static int process_pending_hops(void) {
+    const int hop = zoom_hop();
+    const int fft_size = g_fft_size;
+    int pending = g_new_samples / hop;
+    if (pending == 0) return 0;
+
+    /* Hop h (1 = oldest) ends g_new_samples - h*hop samples before the write
+     * index. Its window must lie within the samples since the last zoom/pan
+     * change: g_new_samples - h*hop + fft_size <= g_iq_fill. */
+    int first_valid = 1;
+    int excess = g_new_samples + fft_size - g_iq_fill;
+    if (excess > hop) first_valid = (excess + hop - 1) / hop;
+    if (first_valid > pending) {
+        g_new_samples -= pending * hop;
+        return 0;
+    }
+
+    if (g_sdft_mode) {
+        /* Slots were filled at each hop boundary; keep the newest batch */
+        int first = (pending > MAX_PENDING_HOPS) ? pending - MAX_PENDING_HOPS + 1 : 1;
+        if (first < first_valid) first = first_valid;
+        g_new_samples -= pending * hop;
+        int rows = 0;
+        for (int h = first; h <= pending; h++) {
+            if (wf_welch_add(&g_welch, g_hop_power[(h - 1) % MAX_PENDING_HOPS])) {
+                emit_row();
+                rows++;
             }
         }
+        return rows;
+    }
+
+    /* Drop hops whose window has left the ring or that exceed a batch */
+    int first = first_valid;
+    if (g_new_samples - hop > IQ_RING_SIZE - fft_size) {
+        int oldest = (g_new_samples - (IQ_RING_SIZE - fft_size) + hop - 1) / hop;
+        if (oldest > first) first = oldest;
+    }
+    if (pending - first + 1 > MAX_PENDING_HOPS) first = pending - MAX_PENDING_HOPS + 1;
+
+    hop_batch_t batch;
+    batch.fft_size = fft_size;
+    int jobs = pending - first + 1;
+    for (int j = 0; j < jobs; j++) {
+        int back = g_new_samples - (first + j) * hop;
+        batch.start[j] = g_iq_buffer + g_iq_buffer_idx + IQ_RING_SIZE - fft_size - back;
+    }
+    g_new_samples -= pending * hop;
+
+    wf_pool_run(g_fft_pool, jobs, fft_hop_job, &batch);
+
+    /* Reassemble in order - Welch accumulate, row every K periodograms */
+    int rows = 0;
+    for (int j = 0; j < jobs; j++) {
+        if (wf_welch_add(&g_welch, g_hop_power[j])) {
+            emit_row();
+            rows++;
+        }
+    }
+    return rows;
+}
+
+/*============================================================================
+ * DSP Thread
+ * Owns the socket: reads one frame at a time without the lock, then
+ * decimates, runs the pending hops and queues finished rows under
+ * g_dsp_lock. Rows never wait for a present.
+ *============================================================================*/
+
+/* HOT PATH - Sample Acquisition (TCP from sdr_server PHXI/IQDQ) */
+static void receive_frame(void) {
+    iqdq_data_frame_t frame;
+    recv_result_t result = tcp_recv_exact(g_socket, &frame, sizeof(frame));
+
+    if (result == RECV_TIMEOUT) {
+        /* No data */
+    } else if (result == RECV_ERROR) {
+        printf("Connection lost\n");
+        disconnect_from_relay();
+    } else if (frame.magic == MAGIC_IQDQ) {
+        /* Check sequence for dropped frames */
+        if (g_last_sequence != 0 && frame.sequence != g_last_sequence + 1) {
+            uint32_t dropped = frame.sequence - g_last_sequence - 1;
+            printf("WARNING: Dropped %u frame(s) (seq %u → %u)\n", 
+                   dropped, g_last_sequence, frame.sequence);
+        }
+        g_last_sequence = frame.sequence;
+
+        /* Calculate bytes per sample based on format */
+        int bytes_per_sample = (g_sample_format == SAMPLE_FORMAT_S16) ? 2 :
+                              (g_sample_format == SAMPLE_FORMAT_F32) ? 4 : 1;
+        int data_bytes = frame.num_samples * 2 * bytes_per_sample;  /* I+Q pairs */
+
+        /* Allocate raw buffer for network data */
+        if (data_bytes > g_raw_buffer_size) {
+            g_raw_buffer = (uint8_t*)realloc(g_raw_buffer, data_bytes);
+            g_raw_buffer_size = data_bytes;
+        }
+
+        /* Allocate sample buffer for float conversion */
+        int float_bytes = frame.num_samples * 2 * sizeof(float);
+        if (float_bytes > g_sample_buffer_size) {
+            g_sample_buffer = (float*)realloc(g_sample_buffer, float_bytes);
+            g_sample_buffer_size = float_bytes;
+        }
+
+        if (tcp_recv_exact(g_socket, g_raw_buffer, data_bytes) != RECV_OK) {
+            disconnect_from_relay();
+            return;
+        }
+
+        SDL_LockMutex(g_dsp_lock);
+        if (g_q15_active) {
+            /* HOT PATH - Integer decimation straight from raw U8/S16 */
+            int max_out = frame.num_samples / g_q15_decim.factor + 1;
+            if (max_out > g_q15_buffer_size) {
+                g_q15_buffer = (wf_q15_cpx*)realloc(g_q15_buffer, max_out * sizeof(wf_q15_cpx));
+                g_q15_buffer_size = max_out;
+            }
+            int produced = (g_sample_format == SAMPLE_FORMAT_S16)
+                ? wf_q15_decim_s16(&g_q15_decim, (const int16_t*)g_raw_buffer, frame.num_samples, g_q15_buffer)
+                : wf_q15_decim_u8(&g_q15_decim, g_raw_buffer, frame.num_samples, g_q15_buffer);
+            for (int s = 0; s < produced; s++) {
+                push_display_sample(g_q15_buffer[s].r * (1.0f / 32768.0f),
+                                    g_q15_buffer[s].i * (1.0f / 32768.0f));
+            }
+        } else {
+            /* Convert samples to float32 based on format */
+            if (g_sample_format == SAMPLE_FORMAT_S16) {
+                pn_s16_to_float((int16_t*)g_raw_buffer, g_sample_buffer, frame.num_samples);
+            } else if (g_sample_format == SAMPLE_FORMAT_U8) {
+                pn_u8_to_float(g_raw_buffer, g_sample_buffer, frame.num_samples);
+            } else {  /* SAMPLE_FORMAT_F32 */
+                memcpy(g_sample_buffer, g_raw_buffer, float_bytes);
+            }
+
+            /* HOT PATH - Decimate and accumulate to FFT buffer */
+            for (uint32_t s = 0; s < frame.num_samples; s++) {
+                float i_sample = g_sample_buffer[s * 2];
+                float q_sample = g_sample_buffer[s * 2 + 1];
+
+                float decimated_i, decimated_q;
+                bool i_ready = pn_decimate_process(&g_decimator_i, i_sample, &decimated_i);
+                bool q_ready = pn_decimate_process(&g_decimator_q, q_sample, &decimated_q);
+
+                /* Both channels should decimate in sync */
+                if (i_ready && q_ready) {
+                    push_display_sample(decimated_i, decimated_q);
+                }
+            }
+        }
+
+        /* HOT PATH - FFT Processing
+         * Window, FFT and |X|^2 for each pending hop (in parallel), then
+         * Welch accumulate and queue completed rows in order */
+        if (g_new_samples >= zoom_hop()) {
+            process_pending_hops();
+        }
+        SDL_UnlockMutex(g_dsp_lock);
+    } else if (frame.magic == MAGIC_META) {
+        /* META frame - read remaining bytes (32 - 16 = 16 bytes) */
+        meta_update_t meta;
+        memcpy(&meta, &frame, sizeof(frame));  /* Copy header we already read */
+        if (tcp_recv_exact(g_socket, ((uint8_t*)&meta) + sizeof(frame), 
+                          sizeof(meta) - sizeof(frame)) == RECV_OK) {
+            printf("META update: seq=%u\n", meta.sequence);
+
+            /* Check if parameters changed requiring reconnection */
+            uint64_t new_freq = ((uint64_t)meta.center_freq_hi << 32) | meta.center_freq_lo;
+            set_center_freq(new_freq);
+
+            /* If sample format or rate changes, trigger complete reinit */
+            printf("  Center freq: %llu Hz, Gain: %.1f dB, LNA: %u\n",
+                   (unsigned long long)new_freq, 
+                   meta.gain_reduction / 10.0f, 
+                   meta.lna_state);
+            /* Note: sdr_server doesn't currently send format/rate changes in META,
+             * but if it did, we'd disconnect and reconnect here */
+        }
+    } else {
+        printf("Unknown frame magic: 0x%08X\n", frame.magic);
+    }
+}
+
+static int dsp_thread_main(void *arg) {
+    (void)arg;
+    while (!SDL_AtomicGet(&g_dsp_quit)) {
+        int request = SDL_AtomicSet(&g_link_request, LINK_NONE);
+        if (request == LINK_DISCONNECT) {
+            disconnect_from_relay();
+        } else if (request == LINK_CONNECT) {
+            connect_to_relay();
+        }
+
+        if (!g_connected) {
+            SDL_Delay(IDLE_POLL_MS);
+            continue;
+        }
+        receive_frame();
     }
+    return 0;
 }
 
 /*============================================================================
@@ -626,6 +2127,131 @@ static void on_service_discovered(const char *id, const char *service,
     }
 }
 
+/*============================================================================
+ * Link Supervision (main thread)
+ *============================================================================*/
+
+static void poll_link(void) {
+    /* Process discovered services (thread-safe from callback) */
+    if (g_service_discovered && !g_connected) {
+        g_service_discovered = false;  /* Clear flag */
+        
+        /* Update connection settings */
+        SDL_LockMutex(g_dsp_lock);
+        strncpy(g_relay_host, g_discovered_ip, sizeof(g_relay_host) - 1);
+        g_relay_port = g_discovered_port;
+        SDL_UnlockMutex(g_dsp_lock);
+        
+#ifdef HAS_GUI
+        /* Update UI widgets safely (we're in main thread) */
+        if (g_ui) {
+            widget_input_set_text(&g_input_host, g_discovered_ip);
+            char port_str[16];
+            snprintf(port_str, sizeof(port_str), "%d", g_discovered_port);
+            widget_input_set_text(&g_input_port, port_str);
+        }
+#endif
+        
+        /* Auto-connect if enabled */
+        if (g_auto_connect) {
+            printf("[DISCOVERY] Auto-connecting to %s:%d\n", g_relay_host, g_relay_port);
+            request_link(LINK_CONNECT);
+        } else {
+            printf("[DISCOVERY] Updated connection fields to %s:%d (auto-connect disabled)\n",
+                   g_relay_host, g_relay_port);
+        }
+    }
+
+    /* Auto-reconnect timer (works with or without discovery) */
+    if (!g_connected) {
+        uint32_t now = SDL_GetTicks();
+        if (now - g_last_reconnect_time >= RECONNECT_INTERVAL_MS) {
+            /* Attempt reconnection (discovery provides target, or use configured host/port) */
+            g_last_reconnect_time = now;
+            if (g_discovery_enabled || strlen(g_relay_host) > 0) {
+                printf("[AUTO-RECONNECT] Attempting connection to %s:%d...\n", 
+                       g_relay_host, g_relay_port);
+                request_link(LINK_CONNECT);
+            }
+        }
+    }
+}
+
+/*============================================================================
+ * Headless Output
+ * The same acquisition -> FFT -> colorize chain as the window, minus the
+ * renderer. This loop only copies pixels; RGB conversion and I/O run on
+ * the encoder thread.
+ *============================================================================*/
+
+/* Whole history, newest row at the top, as the window would show it */
+static void snapshot_history(void) {
+    uint32_t *frame = wf_encoder_begin(g_encoder, g_window_width, g_window_height);
+    if (!frame) return;
+    size_t row_pixels = (size_t)g_window_width;
+    int first = g_window_height - g_history_head;
+    memcpy(frame, g_pixels + g_history_head * row_pixels,
+           first * row_pixels * sizeof(uint32_t));
+    memcpy(frame + first * row_pixels, g_pixels,
+           g_history_head * row_pixels * sizeof(uint32_t));
+    wf_encoder_commit(g_encoder);
+}
+
+/* Rows applied by the last apply_queued_rows(), oldest first; at most
+ * g_window_height, which is all the history ring holds */
+static void stream_rows(int rows) {
+    if (rows <= 0) return;
+    uint32_t *out = wf_encoder_begin(g_encoder, g_window_width, rows);
+    if (!out) {
+        fprintf(stderr, "Headless: out of memory, %d rows dropped\n", rows);
+        return;
+    }
+    size_t row_pixels = (size_t)g_window_width;
+    for (int i = 0; i < rows; i++) {
+        int r = (g_history_head + rows - 1 - i) % g_window_height;
+        memcpy(out + i * row_pixels, g_pixels + r * row_pixels, row_pixels * sizeof(uint32_t));
+    }
+    wf_encoder_commit(g_encoder);
+}
+
+static void run_headless(void) {
+    uint32_t interval_ms = (uint32_t)(g_snapshot_interval_s * 1000.0f);
+    uint32_t next_snapshot = SDL_GetTicks() + interval_ms;
+    bool running = true;
+
+    while (running) {
+        /* SDL turns SIGINT/SIGTERM into SDL_QUIT */
+        SDL_Event event;
+        while (SDL_PollEvent(&event)) {
+            if (event.type == SDL_QUIT) running = false;
+        }
+        poll_link();
+
+        int rows = 0;
+        if (g_output_format == WF_ENCODER_RGB) {
+            /* Stream each batch before the next one can wrap the ring */
+            int batch;
+            while ((batch = apply_queued_rows(g_window_height)) > 0) {
+                stream_rows(batch);
+                rows += batch;
+            }
+        } else {
+            rows = apply_queued_rows(ROW_QUEUE_ROWS);
+        }
+        if (g_recolor_pending) {
+            recolor_history();
+        }
+        g_dirty_rows = 0;                   /* No texture to upload to */
+
+        if (g_output_format != WF_ENCODER_RGB &&
+            SDL_TICKS_PASSED(SDL_GetTicks(), next_snapshot)) {
+            snapshot_history();
+            next_snapshot = SDL_GetTicks() + interval_ms;
+        }
+        if (rows == 0) SDL_Delay(IDLE_POLL_MS);
+    }
+}
+
 /*============================================================================
  * Main
  *============================================================================*/
@@ -639,10 +2265,48 @@ static void print_usage(const char *prog) {
     printf("  --node-id ID      Node ID for discovery (default: WATERFALL-1)\n");
     printf("  --no-discovery    Disable service discovery\n");
     printf("  --no-auto         Disable auto-connect to discovered services\n");
+    printf("  --fft-size N      FFT size, power of two %d-%d (default: %d)\n",
+           WF_FFT_MIN_SIZE, WF_FFT_MAX_SIZE, DEFAULT_FFT_SIZE);
+    printf("  --hop N           Samples between rows at 12 kHz (default: %d)\n", DEFAULT_FFT_HOP);
+    printf("  --fft-engine E    auto, kiss, stockham or q15 (default: auto, tuned into %s)\n", WISDOM_FILE);
+    printf("  --fft-threads N   FFT worker threads, 0 = one per CPU (default: 0)\n");
+    printf("  --avg K           Average K overlapped FFTs per row (default: 1)\n");
+    printf("  --max-hold        Max-hold instead of mean when averaging\n");
+    printf("  --pool MODE       Bins per screen column: max or mean (default: max)\n");
+    printf("  --sdft            Sliding DFT: update on-screen bins every sample\n");
+    printf("  --fixed-point     Q15 decimation and FFT for U8/S16 streams\n");
+    printf("  --palette NAME    classic, grayscale or viridis (default: classic)\n");
+    printf("  --agc-attack S    Auto-gain widening time constant, seconds (default: %.1f)\n", DEFAULT_AGC_ATTACK_S);
+    printf("  --agc-decay S     Auto-gain narrowing time constant, seconds (default: %.1f)\n", DEFAULT_AGC_DECAY_S);
+    printf("  --flatten         Divide out the per-bin noise floor (passband shape, DC)\n");
+    printf("  --no-axes         Hide the frequency and time rulers\n");
+    printf("  --no-trace        Hide the spectrum trace panel\n");
+    printf("  --store FILE      Keep rows in a memory-mapped file for scrollback\n");
+    printf("  --store-mb N      Size of the row store file (default: %d)\n", DEFAULT_STORE_MB);
+    printf("  --size WxH        Window (or headless image) size in pixels\n");
+    printf("  --headless        No window: write images or rows (below) instead\n");
+    printf("  --output PATH     Headless output file, - for stdout (default: -)\n");
+    printf("  --format F        ppm (history snapshots) or rgb (raw RGB24 rows)\n");
+    printf("  --interval S      Seconds between ppm snapshots (default: %.0f)\n", DEFAULT_SNAPSHOT_S);
+    printf("  --benchmark       Compare float and fixed-point paths, then exit\n");
     printf("  --help            Show this help\n\n");
     printf("Runtime keys:\n");
     printf("  Tab        Toggle settings panel\n");
     printf("  +/-        Adjust gain\n");
+    printf("  H          Toggle max-hold averaging\n");
+    printf("  M          Toggle max/mean column pooling\n");
+    printf("  S          Toggle sliding DFT / FFT spectrum\n");
+    printf("  P          Cycle color palette\n");
+    printf("  F          Toggle noise floor flattening\n");
+    printf("  A          Toggle frequency/time rulers\n");
+    printf("  G          Toggle spectrum trace panel\n");
+    printf("  Space      Pause/resume (scrollback, needs --store)\n");
+    printf("  PgUp/PgDn  Scroll back/forward in time (wheel while paused)\n");
+    printf("  [ / ]      Finer/coarser time scale while paused\n");
+    printf("  End        Back to live\n");
+    printf("  Wheel      Zoom frequency span at cursor\n");
+    printf("  Drag/←/→   Pan\n");
+    printf("  0          Reset zoom and pan\n");
     printf("  Q/Esc      Quit\n\n");
     printf("Window is resizable. Settings saved to %s\n", CONFIG_FILE);
 }
@@ -652,6 +2316,7 @@ int main(int argc, char *argv[]) {
     load_config();
 
     /* Parse command line (overrides config) */
+    bool run_benchmark = false;
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "--host") == 0 && i+1 < argc) {
             strncpy(g_relay_host, argv[++i], sizeof(g_relay_host)-1);
@@ -663,14 +2328,87 @@ int main(int argc, char *argv[]) {
             g_discovery_enabled = false;
         } else if (strcmp(argv[i], "--no-auto") == 0) {
             g_auto_connect = false;
+        } else if (strcmp(argv[i], "--fft-size") == 0 && i+1 < argc) {
+            g_fft_size = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--hop") == 0 && i+1 < argc) {
+            g_fft_hop = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fft-engine") == 0 && i+1 < argc) {
+            g_fft_engine = parse_fft_engine(argv[++i]);
+        } else if (strcmp(argv[i], "--fft-threads") == 0 && i+1 < argc) {
+            g_fft_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--avg") == 0 && i+1 < argc) {
+            g_avg_frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-hold") == 0) {
+            g_max_hold = true;
+        } else if (strcmp(argv[i], "--pool") == 0 && i+1 < argc) {
+            g_pool_mode = (strcmp(argv[++i], "mean") == 0) ? WF_POOL_MEAN : WF_POOL_MAX;
+        } else if (strcmp(argv[i], "--sdft") == 0) {
+            g_sdft_mode = true;
+        } else if (strcmp(argv[i], "--fixed-point") == 0) {
+            g_fixed_point = true;
+        } else if (strcmp(argv[i], "--palette") == 0 && i+1 < argc) {
+            g_palette_id = wf_palette_from_name(argv[++i]);
+        } else if (strcmp(argv[i], "--agc-attack") == 0 && i+1 < argc) {
+            g_agc_attack_s = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--agc-decay") == 0 && i+1 < argc) {
+            g_agc_decay_s = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--flatten") == 0) {
+            g_flatten_enabled = true;
+        } else if (strcmp(argv[i], "--no-axes") == 0) {
+            g_axes_enabled = false;
+        } else if (strcmp(argv[i], "--no-trace") == 0) {
+            g_trace_enabled = false;
+        } else if (strcmp(argv[i], "--store") == 0 && i+1 < argc) {
+            strncpy(g_store_path, argv[++i], sizeof(g_store_path)-1);
+        } else if (strcmp(argv[i], "--store-mb") == 0 && i+1 < argc) {
+            g_store_mb = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--size") == 0 && i+1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &g_window_width, &g_window_height) == 2) {
+                if (g_window_width < MIN_WINDOW_WIDTH) g_window_width = MIN_WINDOW_WIDTH;
+                if (g_window_height < MIN_WINDOW_HEIGHT) g_window_height = MIN_WINDOW_HEIGHT;
+            }
+        } else if (strcmp(argv[i], "--headless") == 0) {
+            g_headless = true;
+        } else if (strcmp(argv[i], "--output") == 0 && i+1 < argc) {
+            strncpy(g_output_path, argv[++i], sizeof(g_output_path)-1);
+        } else if (strcmp(argv[i], "--format") == 0 && i+1 < argc) {
+            g_output_format = wf_encoder_format_from_name(argv[++i]);
+            if (g_output_format == WF_ENCODER_FORMAT_COUNT) {
+                fprintf(stderr, "Unknown output format '%s' (ppm, rgb)\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--interval") == 0 && i+1 < argc) {
+            g_snapshot_interval_s = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--benchmark") == 0) {
+            run_benchmark = true;
         } else if (strcmp(argv[i], "--help") == 0) {
             print_usage(argv[0]);
             return 0;
         }
     }
 
+    /* Claim stdout for image data before anything is logged to it */
+    if (g_headless && !run_benchmark) {
+        g_trace_enabled = false;            /* Nothing to draw it on */
+        g_encoder = wf_encoder_create(g_output_path, g_output_format);
+        if (!g_encoder) return 1;
+    }
+
     print_version("Phoenix SDR - Waterfall");
-    printf("Window: %dx%d\n", g_window_width, g_window_height);
+
+    if (run_benchmark) {
+        wf_fixed_benchmark(BENCHMARK_SAMPLE_RATE, DISPLAY_SAMPLE_RATE);
+        return 0;
+    }
+    if (g_headless) {
+        printf("Headless: %dx%d %s to %s", g_window_width, g_window_height,
+               wf_encoder_format_name(g_output_format),
+               strcmp(g_output_path, "-") == 0 ? "stdout" : g_output_path);
+        if (g_output_format == WF_ENCODER_PPM) printf(" every %.1f s", g_snapshot_interval_s);
+        printf("\n");
+    } else {
+        printf("Window: %dx%d\n", g_window_width, g_window_height);
+    }
     printf("Relay: %s:%d\n", g_relay_host, g_relay_port);
 
     /* Initialize networking */
@@ -705,110 +2443,135 @@ int main(int argc, char *argv[]) {
         printf("Discovery: DISABLED\n");
     }
 
-    /* Initialize SDL */
-    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+    /* Initialize SDL (headless: timers and the quit signal only) */
+    if (SDL_Init(g_headless ? (SDL_INIT_TIMER | SDL_INIT_EVENTS) : SDL_INIT_VIDEO) < 0) {
         fprintf(stderr, "SDL_Init failed: %s\n", SDL_GetError());
         return 1;
     }
 
-    g_window = SDL_CreateWindow(
-        "Phoenix Waterfall",
-        SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-        g_window_width, g_window_height,
-        SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE
-    );
-    if (!g_window) {
-        fprintf(stderr, "SDL_CreateWindow failed: %s\n", SDL_GetError());
-        SDL_Quit();
+    if (!g_headless) {
+        g_window = SDL_CreateWindow(
+            "Phoenix Waterfall",
+            SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+            g_window_width, g_window_height,
+            SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE
+        );
+        if (!g_window) {
+            fprintf(stderr, "SDL_CreateWindow failed: %s\n", SDL_GetError());
+            SDL_Quit();
+            return 1;
+        }
+        SDL_SetWindowMinimumSize(g_window, MIN_WINDOW_WIDTH, MIN_WINDOW_HEIGHT);
+
+        g_renderer = SDL_CreateRenderer(g_window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+        if (!g_renderer) {
+            fprintf(stderr, "SDL_CreateRenderer failed\n");
+            SDL_DestroyWindow(g_window);
+            SDL_Quit();
+            return 1;
+        }
+        SDL_RendererInfo renderer_info;
+        if (SDL_GetRendererInfo(g_renderer, &renderer_info) == 0) {
+            g_vsync = (renderer_info.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
+            g_max_texture_width = renderer_info.max_texture_width;
+            g_max_texture_height = renderer_info.max_texture_height;
+            printf("Renderer: %s%s\n", renderer_info.name, g_vsync ? ", vsync" : "");
+        }
+    }
+
+    g_dsp_lock = SDL_CreateMutex();
+    if (!g_dsp_lock) {
+        fprintf(stderr, "SDL_CreateMutex failed\n");
+        return 1;
+    }
+
+    /* FFT worker pool (caller thread counts as one worker) */
+    int fft_threads = g_fft_threads;
+    if (fft_threads <= 0) fft_threads = SDL_GetCPUCount();
+    if (fft_threads > MAX_FFT_THREADS) fft_threads = MAX_FFT_THREADS;
+    g_fft_pool = wf_pool_create(fft_threads - 1);
+    g_fft_workers = (fft_worker_t*)calloc(wf_pool_workers(g_fft_pool) + 1, sizeof(fft_worker_t));
+    printf("FFT threads: %d\n", wf_pool_workers(g_fft_pool) + 1);
+
+    /* I/Q history sized for the largest FFT, so size changes never reallocate */
+    g_iq_buffer = (iq_sample_t*)calloc(2 * IQ_RING_SIZE, sizeof(iq_sample_t));
+
+    if (!g_fft_workers || !alloc_fft_buffers() || !g_iq_buffer ||
+        !wf_welch_init(&g_welch, WF_FFT_MAX_SIZE) ||
+        !wf_flatten_init(&g_flatten, WF_FFT_MAX_SIZE, FLATTEN_QUANTILE)) {
+        fprintf(stderr, "Memory allocation failed\n");
         return 1;
     }
-    SDL_SetWindowMinimumSize(g_window, MIN_WINDOW_WIDTH, MIN_WINDOW_HEIGHT);
 
-    g_renderer = SDL_CreateRenderer(g_window, -1, SDL_RENDERER_ACCELERATED);
-    if (!g_renderer) {
-        fprintf(stderr, "SDL_CreateRenderer failed\n");
-        SDL_DestroyWindow(g_window);
-        SDL_Quit();
+    /* connect_to_relay() switches to q15 for streams on the Q15 front end */
+    wf_fft_init(WISDOM_FILE, g_fft_engine);
+    if (g_fft_engine == WF_FFT_ENGINE_AUTO) wf_fft_autotune();
+    if (!set_fft_params(g_fft_size, g_fft_hop) &&
+        !set_fft_params(DEFAULT_FFT_SIZE, DEFAULT_FFT_HOP)) {
+        fprintf(stderr, "FFT plan allocation failed\n");
         return 1;
     }
+    set_averaging(g_avg_frames, g_max_hold);
+    set_zoom(g_zoom_level, g_pan_hz);
+    wf_palette_build(&g_palette, g_palette_id);
+    wf_agc_init(&g_agc, AGC_FLOOR_PERCENTILE, AGC_PEAK_PERCENTILE,
+                g_agc_attack_s, g_agc_decay_s, -80.0f, -40.0f);
+    g_view_floor_db = g_recolor_floor_db = g_agc.floor_db;
+    g_view_peak_db = g_recolor_peak_db = g_agc.peak_db;
+    g_view_row_seconds = row_seconds();     /* DSP thread not started yet */
 
 #ifdef HAS_GUI
-    g_ui = ui_core_init(g_renderer);
+    if (!g_headless) g_ui = ui_core_init(g_renderer);
     if (g_ui) {
         init_settings_panel();
     }
 #endif
 
-    /* Allocate FFT buffers */
-    g_fft_cfg = kiss_fft_alloc(DISPLAY_FFT_SIZE, 0, NULL, NULL);
-    g_fft_in = (kiss_fft_cpx*)malloc(DISPLAY_FFT_SIZE * sizeof(kiss_fft_cpx));
-    g_fft_out = (kiss_fft_cpx*)malloc(DISPLAY_FFT_SIZE * sizeof(kiss_fft_cpx));
-    g_window_func = (float*)malloc(DISPLAY_FFT_SIZE * sizeof(float));
-    g_iq_buffer = (iq_sample_t*)calloc(DISPLAY_FFT_SIZE, sizeof(iq_sample_t));
-
-    if (!g_fft_cfg || !g_fft_in || !g_fft_out || !g_window_func || !g_iq_buffer) {
-        fprintf(stderr, "Memory allocation failed\n");
-        return 1;
-    }
-
     if (!resize_buffers()) {
         fprintf(stderr, "Failed to allocate display buffers\n");
         return 1;
     }
 
-    generate_blackman_harris(g_window_func, DISPLAY_FFT_SIZE);
+    if (g_store_path[0]) {
+        int capacity = (int)(((size_t)g_store_mb << 20) /
+                             ((STORE_COLUMNS + sizeof(float) + sizeof(wf_rowstore_span_t)) * STORE_LEVELS));
+        g_store_open = wf_rowstore_open(&g_store, g_store_path, STORE_COLUMNS, capacity,
+                                        STORE_LEVELS, HISTORY_DB_STEP);
+        if (g_store_open) {
+            printf("Row store: %s, %d rows per level, about %.1f h at the coarsest level\n",
+                   g_store_path, capacity,
+                   (double)capacity * (1 << (STORE_LEVELS - 1)) * row_seconds() / 3600.0);
+        }
+    }
 
-    printf("\nPress Tab for settings, Q to quit\n\n");
+    if (!g_headless) printf("\nPress Tab for settings, Q to quit\n\n");
 
     /* Wait for service discovery and auto-connect */
     g_show_settings = false;
 
+    /* Acquisition and FFT run on their own thread from here on */
+    g_dsp_thread = SDL_CreateThread(dsp_thread_main, "wf_dsp", NULL);
+    if (!g_dsp_thread) {
+        fprintf(stderr, "DSP thread creation failed: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    if (g_headless) {
+        run_headless();
+    }
+
     /* Main loop */
-    bool running = true;
-    static float *sample_buffer = NULL;
-    static int sample_buffer_size = 0;
+    bool running = !g_headless;
+    bool drawn_connected = false;
+    bool drawn_settings = false;
+    bool drawn_trace = g_trace_enabled;
+    bool drawn_scrollback = false;
+    uint32_t last_present = SDL_GetTicks();
     mouse_state_t mouse = {0};
 
     while (running) {
-        /* Process discovered services (thread-safe from callback) */
-        if (g_service_discovered && !g_connected) {
-            g_service_discovered = false;  /* Clear flag */
-            
-            /* Update connection settings */
-            strncpy(g_relay_host, g_discovered_ip, sizeof(g_relay_host) - 1);
-            g_relay_port = g_discovered_port;
-            
-#ifdef HAS_GUI
-            /* Update UI widgets safely (we're in main thread) */
-            widget_input_set_text(&g_input_host, g_discovered_ip);
-            char port_str[16];
-            snprintf(port_str, sizeof(port_str), "%d", g_discovered_port);
-            widget_input_set_text(&g_input_port, port_str);
-#endif
-            
-            /* Auto-connect if enabled */
-            if (g_auto_connect) {
-                printf("[DISCOVERY] Auto-connecting to %s:%d\n", g_relay_host, g_relay_port);
-                connect_to_relay();
-            } else {
-                printf("[DISCOVERY] Updated connection fields to %s:%d (auto-connect disabled)\n",
-                       g_relay_host, g_relay_port);
-            }
-        }
+        poll_link();
 
-        /* Auto-reconnect timer (works with or without discovery) */
-        if (!g_connected) {
-            uint32_t now = SDL_GetTicks();
-            if (now - g_last_reconnect_time >= RECONNECT_INTERVAL_MS) {
-                /* Attempt reconnection (discovery provides target, or use configured host/port) */
-                if (g_discovery_enabled || strlen(g_relay_host) > 0) {
-                    printf("[AUTO-RECONNECT] Attempting connection to %s:%d...\n", 
-                           g_relay_host, g_relay_port);
-                    connect_to_relay();
-                }
-            }
-        }
-        
         /* Reset per-frame mouse state */
         mouse.left_clicked = false;
         mouse.left_released = false;
@@ -816,28 +2579,40 @@ int main(int argc, char *argv[]) {
 
         SDL_Event event;
         while (SDL_PollEvent(&event)) {
+            /* Handlers change zoom, FFT and column-map state */
+            SDL_LockMutex(g_dsp_lock);
             switch (event.type) {
                 case SDL_QUIT:
                     running = false;
                     break;
 
-                case SDL_WINDOWEVENT:
-                    if (event.window.event == SDL_WINDOWEVENT_RESIZED) {
-                        g_window_width = event.window.data1;
-                        g_window_height = event.window.data2;
-                        if (g_window_width < MIN_WINDOW_WIDTH) g_window_width = MIN_WINDOW_WIDTH;
-                        if (g_window_height < MIN_WINDOW_HEIGHT) g_window_height = MIN_WINDOW_HEIGHT;
-                        resize_buffers();
 #ifdef HAS_GUI
-                        if (g_ui) reposition_settings_panel();
+                case SDL_RENDER_TARGETS_RESET:
+                case SDL_RENDER_DEVICE_RESET:
+                    g_panel_stale = true;   /* Cached overlay contents lost */
+                    g_axis_stale = true;
+                    break;
 #endif
-                        save_config();
+
+                case SDL_WINDOWEVENT:
+                    if (event.window.event == SDL_WINDOWEVENT_RESIZED) {
+                        g_resize_width = event.window.data1;
+                        g_resize_height = event.window.data2;
+                        if (g_resize_width < MIN_WINDOW_WIDTH) g_resize_width = MIN_WINDOW_WIDTH;
+                        if (g_resize_height < MIN_WINDOW_HEIGHT) g_resize_height = MIN_WINDOW_HEIGHT;
+                        g_resize_pending = true;
+                        g_resize_due = SDL_GetTicks() + RESIZE_SETTLE_MS;
                     }
                     break;
 
                 case SDL_MOUSEMOTION:
                     mouse.x = event.motion.x;
                     mouse.y = event.motion.y;
+                    /* Drag to pan (waterfall only, not while the panel is open) */
+                    if ((event.motion.state & SDL_BUTTON_LMASK) && !g_show_settings) {
+                        float hz_per_px = 2.0f * zoom_half_span_hz() / (float)g_window_width;
+                        set_zoom(g_zoom_level, g_pan_hz - event.motion.xrel * hz_per_px);
+                    }
                     break;
 
                 case SDL_MOUSEBUTTONDOWN:
@@ -856,12 +2631,20 @@ int main(int argc, char *argv[]) {
 
                 case SDL_MOUSEWHEEL:
                     mouse.wheel_y = event.wheel.y;
+                    if (!g_show_settings && event.wheel.y != 0) {
+                        if (g_scrollback) {
+                            scroll_history(event.wheel.y > 0 ? -32 : 32);
+                        } else {
+                            zoom_at_column(event.wheel.y > 0 ? 1 : -1, mouse.x);
+                        }
+                    }
                     break;
 
                 case SDL_KEYDOWN:
                     /* Don't process keys when input is focused */
 #ifdef HAS_GUI
-                    if (g_input_host.focused || g_input_port.focused) break;
+                    if (g_input_host.focused || g_input_port.focused ||
+                        g_input_fft_size.focused || g_input_fft_hop.focused) break;
 #endif
                     switch (event.key.keysym.sym) {
                         case SDLK_ESCAPE:
@@ -877,10 +2660,76 @@ int main(int argc, char *argv[]) {
                         case SDLK_TAB:
                             g_show_settings = !g_show_settings;
                             break;
+                        case SDLK_h:
+                            set_averaging(g_avg_frames, !g_max_hold);
+                            printf("Averaging: x%d %s\n", g_avg_frames, g_max_hold ? "max-hold" : "mean");
+                            break;
+                        case SDLK_m:
+                            g_pool_mode = (g_pool_mode == WF_POOL_MAX) ? WF_POOL_MEAN : WF_POOL_MAX;
+                            printf("Column pooling: %s\n", (g_pool_mode == WF_POOL_MAX) ? "max" : "mean");
+                            break;
+                        case SDLK_s:
+                            set_spectrum_mode(!g_sdft_mode);
+                            break;
+                        case SDLK_p:
+                            g_palette_id = (wf_palette_id_t)((g_palette_id + 1) % WF_PALETTE_COUNT);
+                            wf_palette_build(&g_palette, g_palette_id);
+                            g_recolor_pending = true;
+                            printf("Palette: %s\n", wf_palette_name(g_palette_id));
+                            break;
+#ifdef HAS_GUI
+                        case SDLK_a:
+                            g_axes_enabled = !g_axes_enabled;
+                            break;
+#endif
+                        case SDLK_g:
+                            g_trace_enabled = !g_trace_enabled;
+                            wf_trace_reset(&g_trace);
+                            break;
+                        case SDLK_SPACE:
+                            set_scrollback(!g_scrollback);
+                            break;
+                        case SDLK_PAGEUP:
+                        case SDLK_PAGEDOWN:
+                            if (!g_scrollback) set_scrollback(true);
+                            if (g_scrollback) {
+                                int page = (g_window_height - waterfall_top()) / 2;
+                                scroll_history(event.key.keysym.sym == SDLK_PAGEUP ? page : -page);
+                            }
+                            break;
+                        case SDLK_END:
+                            if (g_scrollback) set_scrollback(false);
+                            break;
+                        case SDLK_LEFTBRACKET:
+                        case SDLK_RIGHTBRACKET:
+                            if (g_scrollback) {
+                                int level = g_scroll_level +
+                                    (event.key.keysym.sym == SDLK_RIGHTBRACKET ? 1 : -1);
+                                if (level >= 0 && level < STORE_LEVELS) {
+                                    g_scroll_level = level;
+                                    scroll_history(0);
+                                }
+                            }
+                            break;
+                        case SDLK_f:
+                            g_flatten_enabled = !g_flatten_enabled;
+                            wf_flatten_reset(&g_flatten);
+                            printf("Flatten: %s\n", g_flatten_enabled ? "on" : "off");
+                            break;
+                        case SDLK_LEFT:
+                            set_zoom(g_zoom_level, g_pan_hz - 0.2f * zoom_half_span_hz());
+                            break;
+                        case SDLK_RIGHT:
+                            set_zoom(g_zoom_level, g_pan_hz + 0.2f * zoom_half_span_hz());
+                            break;
+                        case SDLK_0:
+                            set_zoom(0, 0.0f);
+                            break;
                         case SDLK_PLUS:
                         case SDLK_EQUALS:
                         case SDLK_KP_PLUS:
                             g_gain_offset += 3.0f;
+                            g_recolor_pending = true;
 #ifdef HAS_GUI
                             g_slider_gain.value = (int)g_gain_offset;
 #endif
@@ -888,6 +2737,7 @@ int main(int argc, char *argv[]) {
                         case SDLK_MINUS:
                         case SDLK_KP_MINUS:
                             g_gain_offset -= 3.0f;
+                            g_recolor_pending = true;
 #ifdef HAS_GUI
                             g_slider_gain.value = (int)g_gain_offset;
 #endif
@@ -902,185 +2752,71 @@ int main(int argc, char *argv[]) {
                 update_settings_panel(&mouse, &event);
             }
 #endif
+            SDL_UnlockMutex(g_dsp_lock);
         }
 
-        /* Get data */
-        bool got_samples = false;
-
         /*====================================================================
-         * HOT PATH - Sample Acquisition (TCP from sdr_server PHXI/IQDQ)
+         * HOT PATH - Render to Screen
+         * Rows queued by the DSP thread since the last frame are applied
+         * together; with vsync the present paces the loop at the display
+         * refresh regardless of the row rate.
          *====================================================================*/
-        if (g_connected) {
-            iqdq_data_frame_t frame;
-            recv_result_t result = tcp_recv_exact(g_socket, &frame, sizeof(frame));
-
-            if (result == RECV_TIMEOUT) {
-                /* No data */
-            } else if (result == RECV_ERROR) {
-                printf("Connection lost\n");
-                disconnect_from_relay();
-            } else if (frame.magic == MAGIC_IQDQ) {
-                /* Check sequence for dropped frames */
-                if (g_last_sequence != 0 && frame.sequence != g_last_sequence + 1) {
-                    uint32_t dropped = frame.sequence - g_last_sequence - 1;
-                    printf("WARNING: Dropped %u frame(s) (seq %u → %u)\n", 
-                           dropped, g_last_sequence, frame.sequence);
-                }
-                g_last_sequence = frame.sequence;
-
-                /* Calculate bytes per sample based on format */
-                int bytes_per_sample = (g_sample_format == SAMPLE_FORMAT_S16) ? 2 :
-                                      (g_sample_format == SAMPLE_FORMAT_F32) ? 4 : 1;
-                int data_bytes = frame.num_samples * 2 * bytes_per_sample;  /* I+Q pairs */
-
-                /* Allocate raw buffer for network data */
-                if (data_bytes > g_raw_buffer_size) {
-                    g_raw_buffer = (uint8_t*)realloc(g_raw_buffer, data_bytes);
-                    g_raw_buffer_size = data_bytes;
-                }
-
-                /* Allocate sample buffer for float conversion */
-                int float_bytes = frame.num_samples * 2 * sizeof(float);
-                if (float_bytes > sample_buffer_size) {
-                    sample_buffer = (float*)realloc(sample_buffer, float_bytes);
-                    sample_buffer_size = float_bytes;
-                }
-
-                /* HOT PATH - Read samples and convert to float */
-                if (tcp_recv_exact(g_socket, g_raw_buffer, data_bytes) == RECV_OK) {
-                    /* Convert samples to float32 based on format */
-                    if (g_sample_format == SAMPLE_FORMAT_S16) {
-                        pn_s16_to_float((int16_t*)g_raw_buffer, sample_buffer, frame.num_samples);
-                    } else if (g_sample_format == SAMPLE_FORMAT_U8) {
-                        pn_u8_to_float(g_raw_buffer, sample_buffer, frame.num_samples);
-                    } else {  /* SAMPLE_FORMAT_F32 */
-                        memcpy(sample_buffer, g_raw_buffer, float_bytes);
-                    }
-
-                    /* HOT PATH - Decimate and accumulate to FFT buffer */
-                    for (uint32_t s = 0; s < frame.num_samples; s++) {
-                        float i_sample = sample_buffer[s * 2];
-                        float q_sample = sample_buffer[s * 2 + 1];
-                        
-                        float decimated_i, decimated_q;
-                        bool i_ready = pn_decimate_process(&g_decimator_i, i_sample, &decimated_i);
-                        bool q_ready = pn_decimate_process(&g_decimator_q, q_sample, &decimated_q);
-                        
-                        /* Both channels should decimate in sync */
-                        if (i_ready && q_ready) {
-                            g_iq_buffer[g_iq_buffer_idx].i = decimated_i;
-                            g_iq_buffer[g_iq_buffer_idx].q = decimated_q;
-                            g_iq_buffer_idx = (g_iq_buffer_idx + 1) % DISPLAY_FFT_SIZE;
-                            g_new_samples++;
-                        }
-                    }
-                    got_samples = (g_new_samples >= DISPLAY_OVERLAP);
-                } else {
-                    disconnect_from_relay();
-                }
-            } else if (frame.magic == MAGIC_META) {
-                /* META frame - read remaining bytes (32 - 16 = 16 bytes) */
-                meta_update_t meta;
-                memcpy(&meta, &frame, sizeof(frame));  /* Copy header we already read */
-                if (tcp_recv_exact(g_socket, ((uint8_t*)&meta) + sizeof(frame), 
-                                  sizeof(meta) - sizeof(frame)) == RECV_OK) {
-                    printf("META update: seq=%u\n", meta.sequence);
-                    
-                    /* Check if parameters changed requiring reconnection */
-                    uint64_t new_freq = ((uint64_t)meta.center_freq_hi << 32) | meta.center_freq_lo;
-                    (void)new_freq;  /* Unused for now, but logged */
-                    
-                    /* If sample format or rate changes, trigger complete reinit */
-                    printf("  Center freq: %llu Hz, Gain: %.1f dB, LNA: %u\n",
-                           (unsigned long long)new_freq, 
-                           meta.gain_reduction / 10.0f, 
-                           meta.lna_state);
-                    /* Note: sdr_server doesn't currently send format/rate changes in META,
-                     * but if it did, we'd disconnect and reconnect here */
+        /* Apply the last resize once the burst is over */
+        if (g_resize_pending && SDL_TICKS_PASSED(SDL_GetTicks(), g_resize_due)) {
+            g_resize_pending = false;
+            if (g_resize_width != g_window_width || g_resize_height != g_window_height) {
+                SDL_LockMutex(g_dsp_lock);
+                g_window_width = g_resize_width;
+                g_window_height = g_resize_height;
+                if (!resize_buffers()) {
+                    fprintf(stderr, "Failed to resize display buffers\n");
+                    running = false;
                 }
-            } else {
-                printf("Unknown frame magic: 0x%08X\n", frame.magic);
+                SDL_UnlockMutex(g_dsp_lock);
+                schedule_config_save();
             }
-        } else {
-            /* Not connected - auto-reconnect handled below */
         }
-
-        /* Skip if no data AND settings panel not open */
-        if (!got_samples && !g_show_settings) {
-            SDL_Delay(10);
-            continue;
+        if (g_config_dirty && SDL_TICKS_PASSED(SDL_GetTicks(), g_config_due)) {
+            g_config_dirty = false;
+            save_config();
         }
 
-        /*====================================================================
-         * HOT PATH - FFT Processing
-         * Apply Blackman-Harris window and compute FFT
-         *====================================================================*/
-        if (got_samples) {
-            g_new_samples = 0;
-
-            /* Apply window function to I/Q samples */
-            for (int i = 0; i < DISPLAY_FFT_SIZE; i++) {
-                int idx = (g_iq_buffer_idx + i) % DISPLAY_FFT_SIZE;
-                g_fft_in[i].r = g_iq_buffer[idx].i * g_window_func[i];
-                g_fft_in[i].i = g_iq_buffer[idx].q * g_window_func[i];
-            }
-            kiss_fft(g_fft_cfg, g_fft_in, g_fft_out);
-
-            /*================================================================
-             * HOT PATH - Magnitude Calculation
-             * Map FFT bins to screen pixels with frequency zoom
-             *================================================================*/
-            float bin_hz = DISPLAY_HZ_PER_BIN;
-            for (int i = 0; i < g_window_width; i++) {
-                float freq = ((float)i / g_window_width - 0.5f) * 2.0f * ZOOM_MAX_HZ;
-                int bin = (freq >= 0) ? (int)(freq / bin_hz + 0.5f)
-                                      : DISPLAY_FFT_SIZE + (int)(freq / bin_hz - 0.5f);
-                if (bin < 0) bin = 0;
-                if (bin >= DISPLAY_FFT_SIZE) bin = DISPLAY_FFT_SIZE - 1;
-
-                float re = g_fft_out[bin].r;
-                float im = g_fft_out[bin].i;
-                g_magnitudes[i] = sqrtf(re*re + im*im) / DISPLAY_FFT_SIZE;
-            }
+        int rows = apply_queued_rows(ROW_QUEUE_ROWS);
+        if (g_recolor_pending) {
+            recolor_history();
+        }
 
-            /*================================================================
-             * HOT PATH - Auto-Gain (Attack/Decay AGC)
-             * Track peak and floor dB levels for color mapping
-             *================================================================*/
-            float frame_max = -200.0f, frame_min = 200.0f;
-            for (int i = 0; i < g_window_width; i++) {
-                float db = 20.0f * log10f(g_magnitudes[i] + 1e-10f);
-                if (db > frame_max) frame_max = db;
-                if (db < frame_min) frame_min = db;
-            }
-            g_peak_db += ((frame_max > g_peak_db) ? AGC_ATTACK : AGC_DECAY) * (frame_max - g_peak_db);
-            g_floor_db += ((frame_min < g_floor_db) ? AGC_ATTACK : AGC_DECAY) * (frame_min - g_floor_db);
-
-            /*================================================================
-             * HOT PATH - Waterfall Scroll and Row Draw
-             * Scroll existing pixels down, draw new row at top
-             *================================================================*/
-            memmove(g_pixels + g_window_width * 3, g_pixels,
-                    g_window_width * (g_window_height - 1) * 3);
-
-            for (int x = 0; x < g_window_width; x++) {
-                uint8_t r, g, b;
-                magnitude_to_rgb(g_magnitudes[x], g_peak_db, g_floor_db, &r, &g, &b);
-                g_pixels[x*3] = r;
-                g_pixels[x*3+1] = g;
-                g_pixels[x*3+2] = b;
-            }
+        /* Panel only forces a frame when its cached image is out of date */
+        bool panel_changed = g_scrollback && scrollback_changed();
+#ifdef HAS_GUI
+        if (g_show_settings && g_ui) panel_changed |= settings_panel_changed();
+        if (g_ui && axis_overlay_changed()) panel_changed = true;
+#endif
 
-            /* Status indicator overlay */
-            draw_status_indicator();
+        bool connected = g_connected;
+        if (rows == 0 && g_dirty_rows == 0 && !panel_changed &&
+            connected == drawn_connected && g_show_settings == drawn_settings &&
+            g_trace_enabled == drawn_trace && g_scrollback == drawn_scrollback) {
+            SDL_Delay(IDLE_POLL_MS);
+            continue;
         }
+        drawn_connected = connected;
+        drawn_settings = g_show_settings;
+        drawn_trace = g_trace_enabled;
+        drawn_scrollback = g_scrollback;
 
-        /*====================================================================
-         * HOT PATH - Render to Screen
-         *====================================================================*/
-        SDL_UpdateTexture(g_texture, NULL, g_pixels, g_window_width * 3);
+        upload_dirty_rows();
         SDL_RenderClear(g_renderer);
-        SDL_RenderCopy(g_renderer, g_texture, NULL, NULL);
+        if (g_scrollback) {
+            render_scrollback(waterfall_top());
+        } else {
+            render_waterfall(waterfall_top());
+        }
+        if (g_trace_enabled) draw_trace();
+#ifdef HAS_GUI
+        draw_axes();
+#endif
+        draw_status_indicator();
 
         /* Draw settings panel on top */
 #ifdef HAS_GUI
@@ -1090,16 +2826,36 @@ int main(int argc, char *argv[]) {
 #endif
 
         SDL_RenderPresent(g_renderer);
-        
-        /* Small delay when settings panel open but no data */
-        if (!got_samples) {
-            SDL_Delay(16);  /* ~60fps */
+
+        if (!g_vsync) {
+            uint32_t now = SDL_GetTicks();
+            uint32_t elapsed = now - last_present;
+            if (elapsed < FRAME_INTERVAL_MS) SDL_Delay(FRAME_INTERVAL_MS - elapsed);
+            last_present = SDL_GetTicks();
         }
     }
 
     /* Cleanup */
-    save_config();
-    free(sample_buffer);
+    SDL_AtomicSet(&g_dsp_quit, 1);
+    SDL_WaitThread(g_dsp_thread, NULL);
+    SDL_DestroyMutex(g_dsp_lock);
+    if (g_store_open) wf_rowstore_close(&g_store);
+    if (g_rowq.dropped > 0) {
+        printf("Rows dropped while the display was stalled: %u\n", g_rowq.dropped);
+    }
+    if (g_encoder) {
+        unsigned dropped = wf_encoder_dropped(g_encoder);
+        wf_encoder_destroy(g_encoder);      /* Writes out what is queued */
+        if (dropped > 0) {
+            printf("Frames dropped while the encoder was behind: %u\n", dropped);
+        }
+    }
+    /* Headless runs leave the GUI's saved settings alone */
+    if (!g_headless) save_config();
+    free(g_sample_buffer);
+    free(g_raw_buffer);
+    free(g_rowq.codes);
+    free(g_q15_buffer);
     disconnect_from_relay();
     
     /* Shutdown discovery (automatically sends BYE) */
@@ -1110,17 +2866,39 @@ int main(int argc, char *argv[]) {
     tcp_cleanup();
 
 #ifdef HAS_GUI
+    if (g_panel_texture) SDL_DestroyTexture(g_panel_texture);
+    if (g_axis_freq_texture) SDL_DestroyTexture(g_axis_freq_texture);
+    if (g_axis_time_texture) SDL_DestroyTexture(g_axis_time_texture);
     if (g_ui) ui_core_shutdown(g_ui);
 #endif
 
-    free(g_magnitudes);
     free(g_pixels);
+    free(g_history);
+    free(g_history_base);
+    free(g_history_spare);
+    free(g_history_base_spare);
+    free(g_trace_points);
+    wf_trace_free(&g_trace);
+    free(g_scroll_pixels);
+    free(g_scroll_codes);
     free(g_iq_buffer);
-    free(g_window_func);
-    free(g_fft_out);
-    free(g_fft_in);
-    kiss_fft_free(g_fft_cfg);
-
+    int fft_workers = wf_pool_workers(g_fft_pool);
+    wf_pool_destroy(g_fft_pool);
+    if (g_fft_workers) {
+        for (int w = 0; w <= fft_workers; w++) {
+            free(g_fft_workers[w].scratch);
+            free(g_fft_workers[w].out);
+        }
+    }
+    free(g_fft_workers);
+    for (int h = 0; h < MAX_PENDING_HOPS; h++) free(g_hop_power[h]);
+    wf_welch_free(&g_welch);
+    wf_flatten_free(&g_flatten);
+    wf_colmap_free(&g_colmap);
+    wf_sdft_free(&g_sdft);
+    wf_fft_shutdown();
+
+    if (g_scroll_texture) SDL_DestroyTexture(g_scroll_texture);
     if (g_texture) SDL_DestroyTexture(g_texture);
     if (g_renderer) SDL_DestroyRenderer(g_renderer);
     if (g_window) SDL_DestroyWindow(g_window);
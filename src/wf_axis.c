@@ -0,0 +1,91 @@
+/**
+ * @file wf_axis.c
+ * @brief Ruler tick layout implementation
+ */
+
+#include "wf_axis.h"
+#include <math.h>
+#include <stdio.h>
+
+/* Smallest 1/2/5 x 10^n step >= raw */
+static double nice_step(double raw) {
+    double decade = pow(10.0, floor(log10(raw)));
+    double m = raw / decade;
+    if (m <= 1.0) return decade;
+    if (m <= 2.0) return 2.0 * decade;
+    if (m <= 5.0) return 5.0 * decade;
+    return 10.0 * decade;
+}
+
+/* Same for times: past a minute, steps are whole minutes that divide an hour */
+static double nice_time_step(double raw) {
+    static const double minutes[] = { 1, 2, 5, 10, 15, 30, 60, 120, 240, 480, 720, 1440 };
+    if (raw < 60.0) return nice_step(raw);
+    for (int i = 0; i < (int)(sizeof(minutes) / sizeof(minutes[0])); i++) {
+        if (minutes[i] * 60.0 >= raw) return minutes[i] * 60.0;
+    }
+    return nice_step(raw);
+}
+
+/* Digits after the point needed to show multiples of step in unit */
+static int decimals_for(double step, double unit, int max_decimals) {
+    int d = (int)ceil(log10(unit / step) - 1e-9);
+    if (d < 0) d = 0;
+    if (d > max_decimals) d = max_decimals;
+    return d;
+}
+
+int wf_axis_freq_ticks(double center_hz, double left_hz, double right_hz,
+                       int width, int min_spacing, wf_axis_tick_t* ticks) {
+    double span = right_hz - left_hz;
+    if (width <= 0 || span <= 0.0) return 0;
+
+    double step = nice_step(span * min_spacing / width);
+    bool absolute = center_hz > 0.0;
+
+    /* Step from an absolute grid so labels stay round as the center moves */
+    double first = ceil((center_hz + left_hz) / step) * step - center_hz;
+    int count = 0;
+    for (double f = first; f <= right_hz && count < WF_AXIS_MAX_TICKS; f += step) {
+        wf_axis_tick_t* t = &ticks[count++];
+        t->pos = (int)lround((f - left_hz) / span * width);
+        if (fabs(f) < step * 1e-6) f = 0.0;
+        if (absolute) {
+            snprintf(t->label, sizeof(t->label), "%.*f",
+                     decimals_for(step, 1e6, 6), (center_hz + f) / 1e6);
+        } else if (f == 0.0) {
+            snprintf(t->label, sizeof(t->label), "0");
+        } else if (step >= 1000.0 || fabs(f) >= 1000.0) {
+            snprintf(t->label, sizeof(t->label), "%+.*f kHz",
+                     decimals_for(step, 1e3, 3), f / 1e3);
+        } else {
+            snprintf(t->label, sizeof(t->label), "%+.0f Hz", f);
+        }
+    }
+    return count;
+}
+
+int wf_axis_time_ticks(double start_seconds, double row_seconds, int height,
+                       int min_spacing, wf_axis_tick_t* ticks) {
+    if (height <= 0 || row_seconds <= 0.0) return 0;
+
+    double step = nice_time_step(row_seconds * min_spacing);
+    double first = (floor(start_seconds / step) + 1.0) * step;
+    int count = 0;
+    for (double t = first; count < WF_AXIS_MAX_TICKS; t += step) {
+        int y = (int)lround((t - start_seconds) / row_seconds);
+        if (y >= height) break;
+        wf_axis_tick_t* tick = &ticks[count++];
+        tick->pos = y;
+        if (step >= 3600.0) {
+            snprintf(tick->label, sizeof(tick->label), "-%.0f h", t / 3600.0);
+        } else if (step >= 60.0) {
+            snprintf(tick->label, sizeof(tick->label), "-%.0f min", t / 60.0);
+        } else if (t < 1.0) {
+            snprintf(tick->label, sizeof(tick->label), "-%.0f ms", t * 1e3);
+        } else {
+            snprintf(tick->label, sizeof(tick->label), "-%.*f s", decimals_for(step, 1.0, 3), t);
+        }
+    }
+    return count;
+}
@@ -0,0 +1,247 @@
+/**
+ * @file wf_encoder.c
+ * @brief Background frame writer implementation
+ */
+
+#include "wf_encoder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <unistd.h>
+#endif
+
+#define ENCODER_SLOTS   4
+
+typedef struct {
+    uint32_t *argb;
+    size_t capacity;                    /* Pixels allocated */
+    int width;
+    int height;
+} encoder_slot_t;
+
+struct wf_encoder {
+    wf_encoder_format_t format;
+    char path[512];
+    FILE *out;                          /* Stream output; NULL for PPM files */
+    SDL_Thread *thread;
+    SDL_mutex *lock;
+    SDL_cond *cv;                       /* Slot queued or quit (writer waits) */
+    SDL_cond *space;                    /* Slot written (rgb producer waits) */
+
+    /* Slots [tail, head) are queued for the writer (guarded by lock); slot
+     * head % ENCODER_SLOTS belongs to the producer */
+    encoder_slot_t slots[ENCODER_SLOTS];
+    unsigned head;
+    unsigned tail;
+    bool quit;
+    unsigned dropped;
+
+    uint8_t *rgb;                       /* Writer scratch */
+    size_t rgb_capacity;
+};
+
+static const char* g_format_names[WF_ENCODER_FORMAT_COUNT] = { "ppm", "rgb" };
+
+wf_encoder_format_t wf_encoder_format_from_name(const char* name) {
+    for (int f = 0; f < WF_ENCODER_FORMAT_COUNT; f++) {
+        if (strcmp(name, g_format_names[f]) == 0) return (wf_encoder_format_t)f;
+    }
+    return WF_ENCODER_FORMAT_COUNT;
+}
+
+const char* wf_encoder_format_name(wf_encoder_format_t format) {
+    return ((unsigned)format < WF_ENCODER_FORMAT_COUNT) ? g_format_names[format] : "ppm";
+}
+
+/*============================================================================
+ * Writer Thread
+ *============================================================================*/
+
+/* Keep the real stdout for image data; everything else printf()s goes to
+ * stderr from here on, so it can't corrupt the stream */
+static FILE* take_stdout(void) {
+    fflush(stdout);
+#ifdef _WIN32
+    int fd = _dup(_fileno(stdout));
+    if (fd < 0) return NULL;
+    _setmode(fd, _O_BINARY);
+    _dup2(_fileno(stderr), _fileno(stdout));
+    return _fdopen(fd, "wb");
+#else
+    int fd = dup(STDOUT_FILENO);
+    if (fd < 0) return NULL;
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+    return fdopen(fd, "wb");
+#endif
+}
+
+static bool write_rgb(FILE *f, const wf_encoder_t *enc, const encoder_slot_t *slot) {
+    size_t bytes = (size_t)slot->width * slot->height * 3;
+    if (enc->format == WF_ENCODER_PPM &&
+        fprintf(f, "P6\n%d %d\n255\n", slot->width, slot->height) < 0) return false;
+    return fwrite(enc->rgb, 1, bytes, f) == bytes;
+}
+
+/* Replace path with the new image in one step */
+static bool write_ppm_file(const wf_encoder_t *enc, const encoder_slot_t *slot) {
+    char tmp[sizeof(enc->path) + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", enc->path);
+    FILE *f = fopen(tmp, "wb");
+    if (!f) return false;
+    bool ok = write_rgb(f, enc, slot);
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) {
+        remove(tmp);
+        return false;
+    }
+#ifdef _WIN32
+    return MoveFileExA(tmp, enc->path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(tmp, enc->path) == 0;
+#endif
+}
+
+static void write_slot(wf_encoder_t *enc, const encoder_slot_t *slot) {
+    size_t pixels = (size_t)slot->width * slot->height;
+    if (pixels * 3 > enc->rgb_capacity) {
+        uint8_t *rgb = (uint8_t*)realloc(enc->rgb, pixels * 3);
+        if (!rgb) return;
+        enc->rgb = rgb;
+        enc->rgb_capacity = pixels * 3;
+    }
+
+    const uint32_t *restrict src = slot->argb;
+    uint8_t *restrict dst = enc->rgb;
+    for (size_t i = 0; i < pixels; i++) {
+        uint32_t p = src[i];
+        dst[3 * i + 0] = (uint8_t)(p >> 16);
+        dst[3 * i + 1] = (uint8_t)(p >> 8);
+        dst[3 * i + 2] = (uint8_t)p;
+    }
+
+    bool ok;
+    if (enc->out) {
+        ok = write_rgb(enc->out, enc, slot) && fflush(enc->out) == 0;
+    } else {
+        ok = write_ppm_file(enc, slot);
+    }
+    if (!ok) fprintf(stderr, "Encoder: write to %s failed\n", enc->path);
+}
+
+static int writer_main(void *data) {
+    wf_encoder_t *enc = (wf_encoder_t*)data;
+
+    SDL_LockMutex(enc->lock);
+    for (;;) {
+        while (!enc->quit && enc->tail == enc->head) {
+            SDL_CondWait(enc->cv, enc->lock);
+        }
+        if (enc->tail == enc->head) break;      /* Quit with nothing queued */
+        encoder_slot_t *slot = &enc->slots[enc->tail % ENCODER_SLOTS];
+        SDL_UnlockMutex(enc->lock);
+        write_slot(enc, slot);
+        SDL_LockMutex(enc->lock);
+        enc->tail++;
+        SDL_CondSignal(enc->space);
+    }
+    SDL_UnlockMutex(enc->lock);
+    return 0;
+}
+
+/*============================================================================
+ * Public API
+ *============================================================================*/
+
+wf_encoder_t* wf_encoder_create(const char* path, wf_encoder_format_t format) {
+    wf_encoder_t *enc = (wf_encoder_t*)calloc(1, sizeof(wf_encoder_t));
+    if (!enc) return NULL;
+    enc->format = format;
+    snprintf(enc->path, sizeof(enc->path), "%s", strcmp(path, "-") == 0 ? "stdout" : path);
+
+    if (strcmp(path, "-") == 0) {
+        enc->out = take_stdout();
+    } else if (format == WF_ENCODER_RGB) {
+        enc->out = fopen(path, "ab");
+    }
+    if (!enc->out && (strcmp(path, "-") == 0 || format == WF_ENCODER_RGB)) {
+        fprintf(stderr, "Encoder: cannot open %s\n", enc->path);
+        free(enc);
+        return NULL;
+    }
+
+    enc->lock = SDL_CreateMutex();
+    enc->cv = SDL_CreateCond();
+    enc->space = SDL_CreateCond();
+    if (enc->lock && enc->cv && enc->space) {
+        enc->thread = SDL_CreateThread(writer_main, "wf_encoder", enc);
+    }
+    if (!enc->thread) {
+        fprintf(stderr, "Encoder thread creation failed: %s\n", SDL_GetError());
+        wf_encoder_destroy(enc);
+        return NULL;
+    }
+    return enc;
+}
+
+uint32_t* wf_encoder_begin(wf_encoder_t* enc, int width, int height) {
+    SDL_LockMutex(enc->lock);
+    /* A gap in a row stream can't be seen downstream - wait instead. The
+     * writer advances tail even when a write fails, so this always ends. */
+    while (enc->format == WF_ENCODER_RGB && enc->head - enc->tail >= ENCODER_SLOTS) {
+        SDL_CondWait(enc->space, enc->lock);
+    }
+    bool full = enc->head - enc->tail >= ENCODER_SLOTS;
+    if (full) enc->dropped++;
+    encoder_slot_t *slot = &enc->slots[enc->head % ENCODER_SLOTS];
+    SDL_UnlockMutex(enc->lock);
+    if (full) return NULL;
+
+    /* The producer's slot is not queued, so it can be resized unlocked */
+    size_t pixels = (size_t)width * height;
+    if (pixels > slot->capacity) {
+        uint32_t *argb = (uint32_t*)realloc(slot->argb, pixels * sizeof(uint32_t));
+        if (!argb) return NULL;
+        slot->argb = argb;
+        slot->capacity = pixels;
+    }
+    slot->width = width;
+    slot->height = height;
+    return slot->argb;
+}
+
+void wf_encoder_commit(wf_encoder_t* enc) {
+    SDL_LockMutex(enc->lock);
+    enc->head++;
+    SDL_CondSignal(enc->cv);
+    SDL_UnlockMutex(enc->lock);
+}
+
+unsigned wf_encoder_dropped(const wf_encoder_t* enc) {
+    return enc ? enc->dropped : 0;
+}
+
+void wf_encoder_destroy(wf_encoder_t* enc) {
+    if (!enc) return;
+
+    if (enc->thread) {
+        SDL_LockMutex(enc->lock);
+        enc->quit = true;
+        SDL_CondSignal(enc->cv);
+        SDL_UnlockMutex(enc->lock);
+        SDL_WaitThread(enc->thread, NULL);
+    }
+    if (enc->cv) SDL_DestroyCond(enc->cv);
+    if (enc->space) SDL_DestroyCond(enc->space);
+    if (enc->lock) SDL_DestroyMutex(enc->lock);
+    if (enc->out) fclose(enc->out);
+    for (int s = 0; s < ENCODER_SLOTS; s++) free(enc->slots[s].argb);
+    free(enc->rgb);
+    free(enc);
+}
@@ -0,0 +1,603 @@
+/**
+ * @file wf_fft.c
+ * @brief FFT plan cache and engine layer implementation
+ */
+
+#include "wf_fft.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <SDL.h>
+
+#define WF_FFT_NUM_SIZES    9   /* 256 .. 65536 */
+
+#define BENCH_TRIALS        5
+#define BENCH_MIN_POINTS    (1 << 18)   /* Points transformed per trial */
+
+static wf_fft_plan_t g_plans[WF_FFT_NUM_SIZES];
+
+/* Wisdom: engine per size slot, WF_FFT_ENGINE_AUTO = not measured yet */
+static wf_fft_engine_t g_wisdom[WF_FFT_NUM_SIZES] = {
+    WF_FFT_ENGINE_AUTO, WF_FFT_ENGINE_AUTO, WF_FFT_ENGINE_AUTO,
+    WF_FFT_ENGINE_AUTO, WF_FFT_ENGINE_AUTO, WF_FFT_ENGINE_AUTO,
+    WF_FFT_ENGINE_AUTO, WF_FFT_ENGINE_AUTO, WF_FFT_ENGINE_AUTO
+};
+static char g_wisdom_path[256] = {0};
+static wf_fft_engine_t g_engine_override = WF_FFT_ENGINE_AUTO;
+
+static int size_to_slot(int size) {
+    int slot = 0;
+    for (int s = WF_FFT_MIN_SIZE; s < size; s <<= 1) slot++;
+    return slot;
+}
+
+bool wf_fft_size_valid(int size) {
+    return size >= WF_FFT_MIN_SIZE && size <= WF_FFT_MAX_SIZE && (size & (size - 1)) == 0;
+}
+
+/*============================================================================
+ * Window Function (Blackman-Harris)
+ * Built once per size - reduces spectral leakage in FFT
+ *============================================================================*/
+
+static void generate_blackman_harris(float *window, int size) {
+    const float a0 = 0.35875f, a1 = 0.48829f, a2 = 0.14128f, a3 = 0.01168f;
+    const float pi = 3.14159265358979323846f;
+    for (int i = 0; i < size; i++) {
+        float n = (float)i / (float)(size - 1);
+        window[i] = a0 - a1*cosf(2*pi*n) + a2*cosf(4*pi*n) - a3*cosf(6*pi*n);
+    }
+}
+
+/* Expand window[0..size) in place to interleaved form window[0..2*size)
+ * so it can be applied directly to I/Q pairs. Buffer must hold 2*size floats. */
+static void interleave_window(float *window, int size) {
+    for (int i = size - 1; i >= 0; i--) {
+        window[2*i + 1] = window[i];
+        window[2*i] = window[i];
+    }
+}
+
+/*============================================================================
+ * Engine: kiss_fft
+ *============================================================================*/
+
+static void *kiss_create(int size) {
+    return kiss_fft_alloc(size, 0, NULL, NULL);
+}
+
+static void kiss_destroy(void *state) {
+    kiss_fft_free(state);
+}
+
+static void kiss_execute(const void *state, int size, const float *window,
+                         const kiss_fft_cpx *in, kiss_fft_cpx *scratch, kiss_fft_cpx *out) {
+    /* Window as one flat loop over interleaved floats */
+    const float *restrict src = (const float*)in;
+    float *restrict dst = (float*)scratch;
+    for (int i = 0; i < 2 * size; i++) {
+        dst[i] = src[i] * window[i];
+    }
+    kiss_fft((kiss_fft_cfg)state, scratch, out);
+}
+
+/*============================================================================
+ * Engine: Radix-4 Stockham (split re/im)
+ * Autosort - no bit reversal pass. Each stage reads x and writes y with the
+ * twiddle constant across the unit-stride inner q loop, so every stage
+ * vectorizes. An odd log2(size) ends with one radix-2 stage.
+ *============================================================================*/
+
+typedef struct {
+    int size;
+    float *tw_re;   /* exp(-2*pi*i*k/size), k < size */
+    float *tw_im;
+} stockham_t;
+
+static void *stockham_create(int size) {
+    stockham_t *st = (stockham_t*)calloc(1, sizeof(stockham_t));
+    if (!st) return NULL;
+    st->size = size;
+    st->tw_re = (float*)malloc(size * sizeof(float));
+    st->tw_im = (float*)malloc(size * sizeof(float));
+    if (!st->tw_re || !st->tw_im) {
+        free(st->tw_re);
+        free(st->tw_im);
+        free(st);
+        return NULL;
+    }
+    for (int k = 0; k < size; k++) {
+        double a = -2.0 * 3.14159265358979323846 * k / size;
+        st->tw_re[k] = (float)cos(a);
+        st->tw_im[k] = (float)sin(a);
+    }
+    return st;
+}
+
+static void stockham_destroy(void *state) {
+    stockham_t *st = (stockham_t*)state;
+    if (!st) return;
+    free(st->tw_re);
+    free(st->tw_im);
+    free(st);
+}
+
+static void stockham_radix4(int n, int s, const stockham_t *st,
+                            const float *restrict xr, const float *restrict xi,
+                            float *restrict yr, float *restrict yi) {
+    const int m = n / 4;
+    for (int p = 0; p < m; p++) {
+        const int k = p * s;       /* W_n^p == W_size^(p*s) */
+        const float w1r = st->tw_re[k],     w1i = st->tw_im[k];
+        const float w2r = st->tw_re[2*k],   w2i = st->tw_im[2*k];
+        const float w3r = st->tw_re[3*k],   w3i = st->tw_im[3*k];
+        const float *ar = xr + s*p,       *ai = xi + s*p;
+        const float *br = xr + s*(p+m),   *bi = xi + s*(p+m);
+        const float *cr = xr + s*(p+2*m), *ci = xi + s*(p+2*m);
+        const float *dr = xr + s*(p+3*m), *di = xi + s*(p+3*m);
+        float *y0r = yr + s*(4*p),   *y0i = yi + s*(4*p);
+        float *y1r = yr + s*(4*p+1), *y1i = yi + s*(4*p+1);
+        float *y2r = yr + s*(4*p+2), *y2i = yi + s*(4*p+2);
+        float *y3r = yr + s*(4*p+3), *y3i = yi + s*(4*p+3);
+        for (int q = 0; q < s; q++) {
+            float apc_r = ar[q] + cr[q], apc_i = ai[q] + ci[q];
+            float amc_r = ar[q] - cr[q], amc_i = ai[q] - ci[q];
+            float bpd_r = br[q] + dr[q], bpd_i = bi[q] + di[q];
+            /* j*(b - d) */
+            float jbmd_r = di[q] - bi[q], jbmd_i = br[q] - dr[q];
+
+            y0r[q] = apc_r + bpd_r;
+            y0i[q] = apc_i + bpd_i;
+
+            float t1r = amc_r - jbmd_r, t1i = amc_i - jbmd_i;
+            y1r[q] = t1r*w1r - t1i*w1i;
+            y1i[q] = t1r*w1i + t1i*w1r;
+
+            float t2r = apc_r - bpd_r, t2i = apc_i - bpd_i;
+            y2r[q] = t2r*w2r - t2i*w2i;
+            y2i[q] = t2r*w2i + t2i*w2r;
+
+            float t3r = amc_r + jbmd_r, t3i = amc_i + jbmd_i;
+            y3r[q] = t3r*w3r - t3i*w3i;
+            y3i[q] = t3r*w3i + t3i*w3r;
+        }
+    }
+}
+
+/* Final radix-2 stage (n == 2, no twiddles) */
+static void stockham_radix2(int s, const float *restrict xr, const float *restrict xi,
+                            float *restrict yr, float *restrict yi) {
+    for (int q = 0; q < s; q++) {
+        float ar = xr[q], ai = xi[q], br = xr[q + s], bi = xi[q + s];
+        yr[q] = ar + br;
+        yi[q] = ai + bi;
+        yr[q + s] = ar - br;
+        yi[q + s] = ai - bi;
+    }
+}
+
+static void stockham_execute(const void *state, int size, const float *window,
+                             const kiss_fft_cpx *in, kiss_fft_cpx *scratch, kiss_fft_cpx *out) {
+    const stockham_t *st = (const stockham_t*)state;
+    float *xr = (float*)scratch;
+    float *xi = xr + size;
+    float *yr = xi + size;
+    float *yi = yr + size;
+
+    /* Window and de-interleave into split arrays */
+    const float *restrict src = (const float*)in;
+    for (int i = 0; i < size; i++) {
+        xr[i] = src[2*i] * window[2*i];
+        xi[i] = src[2*i + 1] * window[2*i + 1];
+    }
+
+    int n = size, s = 1;
+    while (n >= 4) {
+        stockham_radix4(n, s, st, xr, xi, yr, yi);
+        float *t;
+        t = xr; xr = yr; yr = t;
+        t = xi; xi = yi; yi = t;
+        n /= 4;
+        s *= 4;
+    }
+    if (n == 2) {
+        stockham_radix2(s, xr, xi, yr, yi);
+        xr = yr;
+        xi = yi;
+    }
+
+    /* Re-interleave */
+    float *restrict dst = (float*)out;
+    for (int i = 0; i < size; i++) {
+        dst[2*i] = xr[i];
+        dst[2*i + 1] = xi[i];
+    }
+}
+
+/*============================================================================
+ * Engine: Q15 radix-2 (split int16 re/im)
+ * Input is windowed and quantized straight into bit-reversed order, then
+ * log2(size) in-place DIT stages. Every butterfly halves its outputs, so
+ * nothing can overflow and the result is FFT/size. Per-stage twiddles are
+ * stored contiguously, so the inner loop is unit-stride 16x16->32 bit
+ * multiplies that vectorize on SSE2/NEON.
+ *============================================================================*/
+
+/* Input float -> Q15. 1/sqrt(2) of full scale keeps |I + jQ| <= 32767
+ * for I/Q within [-1, 1], which bounds every butterfly output. */
+#define Q15_INPUT_SCALE     23170.0f
+
+typedef struct {
+    int size;
+    uint16_t *bitrev;
+    int16_t *tw_re;     /* Stage with half-span h at [h-1, 2h-1) */
+    int16_t *tw_im;
+} q15_fft_t;
+
+static void q15_destroy(void *state) {
+    q15_fft_t *st = (q15_fft_t*)state;
+    if (!st) return;
+    free(st->bitrev);
+    free(st->tw_re);
+    free(st->tw_im);
+    free(st);
+}
+
+static void *q15_create(int size) {
+    if (size > 65536) return NULL;     /* uint16_t bit-reverse table */
+    q15_fft_t *st = (q15_fft_t*)calloc(1, sizeof(q15_fft_t));
+    if (!st) return NULL;
+    st->size = size;
+    st->bitrev = (uint16_t*)malloc(size * sizeof(uint16_t));
+    st->tw_re = (int16_t*)malloc(size * sizeof(int16_t));
+    st->tw_im = (int16_t*)malloc(size * sizeof(int16_t));
+    if (!st->bitrev || !st->tw_re || !st->tw_im) {
+        q15_destroy(st);
+        return NULL;
+    }
+
+    int bits = 0;
+    while ((1 << bits) < size) bits++;
+    for (int i = 0; i < size; i++) {
+        int r = 0;
+        for (int b = 0; b < bits; b++) r |= ((i >> b) & 1) << (bits - 1 - b);
+        st->bitrev[i] = (uint16_t)r;
+    }
+    for (int half = 1; half < size; half <<= 1) {
+        for (int j = 0; j < half; j++) {
+            double a = -3.14159265358979323846 * j / half;
+            st->tw_re[half - 1 + j] = (int16_t)lrint(32767.0 * cos(a));
+            st->tw_im[half - 1 + j] = (int16_t)lrint(32767.0 * sin(a));
+        }
+    }
+    return st;
+}
+
+static inline int16_t q15_quantize(float v) {
+    v *= Q15_INPUT_SCALE;
+    if (v > 32767.0f) v = 32767.0f;
+    if (v < -32767.0f) v = -32767.0f;
+    return (int16_t)v;
+}
+
+static void q15_execute(const void *state, int size, const float *window,
+                        const kiss_fft_cpx *in, kiss_fft_cpx *scratch, kiss_fft_cpx *out) {
+    const q15_fft_t *st = (const q15_fft_t*)state;
+    int16_t *xr = (int16_t*)scratch;
+    int16_t *xi = xr + size;
+
+    /* Window, quantize, bit-reverse */
+    const float *restrict src = (const float*)in;
+    for (int i = 0; i < size; i++) {
+        int k = st->bitrev[i];
+        xr[i] = q15_quantize(src[2*k] * window[2*k]);
+        xi[i] = q15_quantize(src[2*k + 1] * window[2*k + 1]);
+    }
+
+    for (int half = 1; half < size; half <<= 1) {
+        const int16_t *restrict wr = st->tw_re + half - 1;
+        const int16_t *restrict wi = st->tw_im + half - 1;
+        for (int b = 0; b < size; b += 2 * half) {
+            int16_t *restrict ar = xr + b;
+            int16_t *restrict ai = xi + b;
+            int16_t *restrict br = ar + half;
+            int16_t *restrict bi = ai + half;
+            for (int j = 0; j < half; j++) {
+                int32_t tr = ((int32_t)br[j] * wr[j] - (int32_t)bi[j] * wi[j] + (1 << 14)) >> 15;
+                int32_t ti = ((int32_t)br[j] * wi[j] + (int32_t)bi[j] * wr[j] + (1 << 14)) >> 15;
+                int32_t pr = ar[j], pi = ai[j];
+                ar[j] = (int16_t)((pr + tr + 1) >> 1);
+                ai[j] = (int16_t)((pi + ti + 1) >> 1);
+                br[j] = (int16_t)((pr - tr + 1) >> 1);
+                bi[j] = (int16_t)((pi - ti + 1) >> 1);
+            }
+        }
+    }
+
+    /* Back to float at the same scale as the float engines */
+    const float scale = (float)size / Q15_INPUT_SCALE;
+    float *restrict dst = (float*)out;
+    for (int i = 0; i < size; i++) {
+        dst[2*i] = xr[i] * scale;
+        dst[2*i + 1] = xi[i] * scale;
+    }
+}
+
+/*============================================================================
+ * Engine Table
+ *============================================================================*/
+
+typedef struct {
+    const char *name;
+    bool autotune;      /* Candidate for AUTO (full float precision) */
+    void *(*create)(int size);
+    void (*destroy)(void *state);
+    void (*execute)(const void *state, int size, const float *window,
+                    const kiss_fft_cpx *in, kiss_fft_cpx *scratch, kiss_fft_cpx *out);
+} fft_engine_ops_t;
+
+static const fft_engine_ops_t g_engines[WF_FFT_ENGINE_COUNT] = {
+    { "kiss",     true,  kiss_create,     kiss_destroy,     kiss_execute },
+    { "stockham", true,  stockham_create, stockham_destroy, stockham_execute },
+    { "q15",      false, q15_create,      q15_destroy,      q15_execute },
+};
+
+const char* wf_fft_engine_name(wf_fft_engine_t engine) {
+    if (engine < 0 || engine >= WF_FFT_ENGINE_COUNT) return "auto";
+    return g_engines[engine].name;
+}
+
+wf_fft_engine_t wf_fft_engine_from_name(const char* name) {
+    if (!name) return WF_FFT_ENGINE_COUNT;
+    if (strcmp(name, "auto") == 0) return WF_FFT_ENGINE_AUTO;
+    for (int e = 0; e < WF_FFT_ENGINE_COUNT; e++) {
+        if (strcmp(name, g_engines[e].name) == 0) return (wf_fft_engine_t)e;
+    }
+    return WF_FFT_ENGINE_COUNT;
+}
+
+/*============================================================================
+ * Wisdom File
+ * One "size=engine" line per measured size, next to waterfall.ini
+ *============================================================================*/
+
+static void load_wisdom(void) {
+    FILE *f = fopen(g_wisdom_path, "r");
+    if (!f) return;
+
+    char line[128];
+    while (fgets(line, sizeof(line), f)) {
+        int size;
+        char name[32];
+        if (sscanf(line, "%d=%31s", &size, name) == 2 && wf_fft_size_valid(size)) {
+            wf_fft_engine_t engine = wf_fft_engine_from_name(name);
+            if (engine != WF_FFT_ENGINE_COUNT) g_wisdom[size_to_slot(size)] = engine;
+        }
+    }
+    fclose(f);
+}
+
+static void save_wisdom(void) {
+    if (!g_wisdom_path[0]) return;
+    FILE *f = fopen(g_wisdom_path, "w");
+    if (!f) return;
+
+    fprintf(f, "; Phoenix Waterfall FFT wisdom (fastest engine per size)\n");
+    for (int slot = 0; slot < WF_FFT_NUM_SIZES; slot++) {
+        if (g_wisdom[slot] != WF_FFT_ENGINE_AUTO) {
+            fprintf(f, "%d=%s\n", WF_FFT_MIN_SIZE << slot, g_engines[g_wisdom[slot]].name);
+        }
+    }
+    fclose(f);
+}
+
+void wf_fft_init(const char* wisdom_path, wf_fft_engine_t engine) {
+    g_engine_override = engine;
+    g_wisdom_path[0] = '\0';
+    if (wisdom_path) {
+        strncpy(g_wisdom_path, wisdom_path, sizeof(g_wisdom_path) - 1);
+        load_wisdom();
+    }
+}
+
+static void free_plan(wf_fft_plan_t *plan) {
+    if (plan->state) g_engines[plan->engine].destroy(plan->state);
+    free(plan->window);
+    memset(plan, 0, sizeof(*plan));
+}
+
+void wf_fft_set_engine(wf_fft_engine_t engine) {
+    if (engine == g_engine_override) return;
+    g_engine_override = engine;
+
+    /* Drop plans the new override would not pick; they are rebuilt in place */
+    for (int i = 0; i < WF_FFT_NUM_SIZES; i++) {
+        wf_fft_engine_t want = (engine == WF_FFT_ENGINE_AUTO) ? g_wisdom[i] : engine;
+        if (g_plans[i].state && g_plans[i].engine != want) free_plan(&g_plans[i]);
+    }
+}
+
+/*============================================================================
+ * Autotune
+ * Times each engine on noise input (best of BENCH_TRIALS) and returns the
+ * fastest. Runs once per size; the result is persisted as wisdom.
+ *============================================================================*/
+
+static void fill_noise(kiss_fft_cpx *in, int size) {
+    uint32_t seed = 12345;
+    for (int i = 0; i < size; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        in[i].r = (float)(seed >> 8) / 16777216.0f - 0.5f;
+        seed = seed * 1664525u + 1013904223u;
+        in[i].i = (float)(seed >> 8) / 16777216.0f - 0.5f;
+    }
+}
+
+/* Seconds per transform for engine e, or -1 if it can't be created */
+static double time_engine(wf_fft_engine_t e, int size, const float *window,
+                          const kiss_fft_cpx *in, kiss_fft_cpx *scratch, kiss_fft_cpx *out) {
+    void *state = g_engines[e].create(size);
+    if (!state) return -1.0;
+
+    int reps = BENCH_MIN_POINTS / size;
+    if (reps < 2) reps = 2;
+    double freq = (double)SDL_GetPerformanceFrequency();
+
+    g_engines[e].execute(state, size, window, in, scratch, out);  /* Warm up */
+    double engine_time = 1e30;
+    for (int t = 0; t < BENCH_TRIALS; t++) {
+        uint64_t start = SDL_GetPerformanceCounter();
+        for (int r = 0; r < reps; r++) {
+            g_engines[e].execute(state, size, window, in, scratch, out);
+        }
+        double elapsed = (double)(SDL_GetPerformanceCounter() - start) / freq / reps;
+        if (elapsed < engine_time) engine_time = elapsed;
+    }
+    g_engines[e].destroy(state);
+    return engine_time;
+}
+
+static wf_fft_engine_t autotune(int size, const float *window) {
+    kiss_fft_cpx *in = (kiss_fft_cpx*)malloc(size * sizeof(kiss_fft_cpx));
+    kiss_fft_cpx *scratch = (kiss_fft_cpx*)malloc(WF_FFT_SCRATCH_SIZE(size) * sizeof(kiss_fft_cpx));
+    kiss_fft_cpx *out = (kiss_fft_cpx*)malloc(size * sizeof(kiss_fft_cpx));
+    if (!in || !scratch || !out) {
+        free(in); free(scratch); free(out);
+        return WF_FFT_ENGINE_KISS;
+    }
+    fill_noise(in, size);
+
+    wf_fft_engine_t best = WF_FFT_ENGINE_KISS;
+    double best_time = 1e30;
+
+    for (int e = 0; e < WF_FFT_ENGINE_COUNT; e++) {
+        if (!g_engines[e].autotune) continue;
+        double engine_time = time_engine((wf_fft_engine_t)e, size, window, in, scratch, out);
+        if (engine_time < 0) continue;
+
+        printf("FFT autotune: %5d-point %-8s %8.1f us\n", size, g_engines[e].name, engine_time * 1e6);
+        if (engine_time < best_time) {
+            best_time = engine_time;
+            best = (wf_fft_engine_t)e;
+        }
+    }
+
+    free(in);
+    free(scratch);
+    free(out);
+    return best;
+}
+
+void wf_fft_autotune(void) {
+    bool tuned = false;
+    float *window = (float*)malloc(2 * WF_FFT_MAX_SIZE * sizeof(float));
+    if (!window) return;
+    for (int slot = 0; slot < WF_FFT_NUM_SIZES; slot++) {
+        if (g_wisdom[slot] != WF_FFT_ENGINE_AUTO) continue;
+        int size = WF_FFT_MIN_SIZE << slot;
+        generate_blackman_harris(window, size);
+        interleave_window(window, size);
+        g_wisdom[slot] = autotune(size, window);
+        tuned = true;
+    }
+    free(window);
+    if (tuned) save_wisdom();
+}
+
+double wf_fft_benchmark(wf_fft_engine_t engine, int size, double* err_db) {
+    if (!wf_fft_size_valid(size) || engine < 0 || engine >= WF_FFT_ENGINE_COUNT) return -1.0;
+
+    float *window = (float*)malloc(2 * size * sizeof(float));
+    kiss_fft_cpx *in = (kiss_fft_cpx*)malloc(size * sizeof(kiss_fft_cpx));
+    kiss_fft_cpx *scratch = (kiss_fft_cpx*)malloc(WF_FFT_SCRATCH_SIZE(size) * sizeof(kiss_fft_cpx));
+    kiss_fft_cpx *out = (kiss_fft_cpx*)malloc(size * sizeof(kiss_fft_cpx));
+    kiss_fft_cpx *ref = (kiss_fft_cpx*)malloc(size * sizeof(kiss_fft_cpx));
+    double seconds = -1.0;
+    if (window && in && scratch && out && ref) {
+        generate_blackman_harris(window, size);
+        interleave_window(window, size);
+        fill_noise(in, size);
+        seconds = time_engine(engine, size, window, in, scratch, out);
+
+        if (err_db && seconds >= 0) {
+            void *kiss = kiss_create(size);
+            if (kiss) {
+                kiss_execute(kiss, size, window, in, scratch, ref);
+                kiss_destroy(kiss);
+                double err = 0.0, sig = 0.0;
+                for (int k = 0; k < size; k++) {
+                    double dr = out[k].r - ref[k].r, di = out[k].i - ref[k].i;
+                    err += dr * dr + di * di;
+                    sig += (double)ref[k].r * ref[k].r + (double)ref[k].i * ref[k].i;
+                }
+                *err_db = 10.0 * log10((err + 1e-30) / (sig + 1e-30));
+            }
+        }
+    }
+    free(window);
+    free(in);
+    free(scratch);
+    free(out);
+    free(ref);
+    return seconds;
+}
+
+/*============================================================================
+ * Plan Cache
+ *============================================================================*/
+
+const wf_fft_plan_t* wf_fft_get_plan(int size) {
+    if (!wf_fft_size_valid(size)) return NULL;
+
+    int slot = size_to_slot(size);
+    wf_fft_plan_t *plan = &g_plans[slot];
+    if (plan->state) return plan;
+
+    plan->window = (float*)malloc(2 * size * sizeof(float));
+    if (!plan->window) {
+        fprintf(stderr, "FFT plan allocation failed (size %d)\n", size);
+        return NULL;
+    }
+    generate_blackman_harris(plan->window, size);
+    interleave_window(plan->window, size);
+
+    /* Never benchmark here - callers may hold the DSP lock. Untuned sizes
+     * use kiss until wf_fft_autotune() has run. */
+    wf_fft_engine_t engine = g_engine_override;
+    if (engine == WF_FFT_ENGINE_AUTO) {
+        engine = (g_wisdom[slot] == WF_FFT_ENGINE_AUTO) ? WF_FFT_ENGINE_KISS : g_wisdom[slot];
+    }
+
+    plan->state = g_engines[engine].create(size);
+    if (!plan->state && engine != WF_FFT_ENGINE_KISS) {
+        engine = WF_FFT_ENGINE_KISS;
+        plan->state = g_engines[engine].create(size);
+    }
+    if (!plan->state) {
+        fprintf(stderr, "FFT plan allocation failed (size %d)\n", size);
+        free(plan->window);
+        plan->window = NULL;
+        return NULL;
+    }
+
+    plan->engine = engine;
+    plan->size = size;
+    printf("FFT engine: %s for %d points\n", g_engines[engine].name, size);
+    return plan;
+}
+
+/*============================================================================
+ * Execute (HOT PATH)
+ *============================================================================*/
+
+void wf_fft_execute(const wf_fft_plan_t* plan, const kiss_fft_cpx* in,
+                    kiss_fft_cpx* scratch, kiss_fft_cpx* out) {
+    g_engines[plan->engine].execute(plan->state, plan->size, plan->window, in, scratch, out);
+}
+
+void wf_fft_shutdown(void) {
+    for (int i = 0; i < WF_FFT_NUM_SIZES; i++) {
+        free_plan(&g_plans[i]);
+    }
+}
@@ -0,0 +1,258 @@
+/**
+ * @file wf_fixed.c
+ * @brief Fixed-point (Q15) front end implementation
+ */
+
+#include "wf_fixed.h"
+#include "wf_fft.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <SDL.h>
+#include "pn_dsp.h"
+
+static inline int16_t sat16(int64_t v) {
+    if (v > 32767) return 32767;
+    if (v < -32768) return -32768;
+    return (int16_t)v;
+}
+
+/*============================================================================
+ * Setup
+ *============================================================================*/
+
+/* Blackman-windowed sinc, cutoff at the output Nyquist (1/(2*DECIM) of the
+ * FIR input rate), unity DC gain in Q15 */
+static void design_fir(int16_t *taps) {
+    const double pi = 3.14159265358979323846;
+    const double fc = 0.5 / WF_Q15_FIR_DECIM;
+    const double mid = (WF_Q15_FIR_TAPS - 1) / 2.0;
+    double h[WF_Q15_FIR_TAPS];
+    double sum = 0.0;
+    for (int n = 0; n < WF_Q15_FIR_TAPS; n++) {
+        double t = n - mid;
+        double sinc = (t == 0.0) ? 2.0 * fc : sin(2.0 * pi * fc * t) / (pi * t);
+        double w = 0.42 - 0.5 * cos(2.0 * pi * n / (WF_Q15_FIR_TAPS - 1))
+                        + 0.08 * cos(4.0 * pi * n / (WF_Q15_FIR_TAPS - 1));
+        h[n] = sinc * w;
+        sum += h[n];
+    }
+    int total = 0;
+    for (int n = 0; n < WF_Q15_FIR_TAPS; n++) {
+        taps[n] = (int16_t)lrint(32768.0 * h[n] / sum);
+        total += taps[n];
+    }
+    /* Put the rounding residue in the center taps so DC gain is exact */
+    taps[WF_Q15_FIR_TAPS / 2] += (int16_t)(32768 - total);
+}
+
+bool wf_q15_decim_init(wf_q15_decim_t* dec, int factor, int bits) {
+    memset(dec, 0, sizeof(*dec));
+
+    int r = (factor + WF_Q15_FIR_DECIM / 2) / WF_Q15_FIR_DECIM;
+    if (r < 2 || r > 1024) return false;    /* R^3 must stay below 2^31 */
+    dec->cic_factor = r;
+    dec->factor = r * WF_Q15_FIR_DECIM;
+
+    /* CIC gain is R^order; pre-shift the input until the peak fits int32 */
+    uint64_t gain = 1;
+    for (int k = 0; k < WF_Q15_CIC_ORDER; k++) gain *= (uint64_t)r;
+    int shift = 0;
+    while ((gain << (bits - 1 - shift)) >= (1ull << 31)) shift++;
+    dec->in_shift = shift;
+
+    double full = ldexp((double)gain, bits - 1 - shift);
+    dec->scale = (int64_t)(32767.0 * 4294967296.0 / full);
+
+    design_fir(dec->taps);
+    return true;
+}
+
+/*============================================================================
+ * Decimation (HOT PATH)
+ *============================================================================*/
+
+static inline int16_t cic_comb(uint32_t *delay, uint32_t v, int64_t scale) {
+    for (int k = 0; k < WF_Q15_CIC_ORDER; k++) {
+        uint32_t y = v - delay[k];
+        delay[k] = v;
+        v = y;
+    }
+    return sat16(((int64_t)(int32_t)v * scale) >> 32);
+}
+
+/* One CIC output into the FIR; returns 1 when an output sample is ready */
+static inline int fir_push(wf_q15_decim_t *dec, int16_t ci, int16_t cq, wf_q15_cpx *out) {
+    int h = dec->hist_idx;
+    dec->hist[0][h] = dec->hist[0][h + WF_Q15_FIR_TAPS] = ci;
+    dec->hist[1][h] = dec->hist[1][h + WF_Q15_FIR_TAPS] = cq;
+    if (++h == WF_Q15_FIR_TAPS) h = 0;
+    dec->hist_idx = h;
+    if (++dec->fir_phase < WF_Q15_FIR_DECIM) return 0;
+    dec->fir_phase = 0;
+
+    /* Newest WF_Q15_FIR_TAPS samples are contiguous from h (mirror) */
+    const int16_t *restrict xi = dec->hist[0] + h;
+    const int16_t *restrict xq = dec->hist[1] + h;
+    const int16_t *restrict taps = dec->taps;
+    int32_t ai = 0, aq = 0;
+    for (int k = 0; k < WF_Q15_FIR_TAPS; k++) {
+        ai += (int32_t)xi[k] * taps[k];
+        aq += (int32_t)xq[k] * taps[k];
+    }
+    out->r = sat16((ai + (1 << 14)) >> 15);
+    out->i = sat16((aq + (1 << 14)) >> 15);
+    return 1;
+}
+
+static inline int push_sample(wf_q15_decim_t *dec, int32_t xi, int32_t xq, wf_q15_cpx *out) {
+    uint32_t *a = dec->integ[0];
+    uint32_t *b = dec->integ[1];
+    a[0] += (uint32_t)xi;  a[1] += a[0];  a[2] += a[1];
+    b[0] += (uint32_t)xq;  b[1] += b[0];  b[2] += b[1];
+    if (++dec->cic_count < dec->cic_factor) return 0;
+    dec->cic_count = 0;
+    int16_t ci = cic_comb(dec->comb[0], a[2], dec->scale);
+    int16_t cq = cic_comb(dec->comb[1], b[2], dec->scale);
+    return fir_push(dec, ci, cq, out);
+}
+
+int wf_q15_decim_s16(wf_q15_decim_t* dec, const int16_t* iq, int n, wf_q15_cpx* out) {
+    const int shift = dec->in_shift;
+    int produced = 0;
+    for (int s = 0; s < n; s++) {
+        produced += push_sample(dec, iq[2*s] >> shift, iq[2*s + 1] >> shift, out + produced);
+    }
+    return produced;
+}
+
+int wf_q15_decim_u8(wf_q15_decim_t* dec, const uint8_t* iq, int n, wf_q15_cpx* out) {
+    /* 2v - 255 centers rtl-style offset binary exactly (odd, 9 bits) */
+    const int shift = dec->in_shift;
+    int produced = 0;
+    for (int s = 0; s < n; s++) {
+        int32_t xi = (2 * (int32_t)iq[2*s] - 255) >> shift;
+        int32_t xq = (2 * (int32_t)iq[2*s + 1] - 255) >> shift;
+        produced += push_sample(dec, xi, xq, out + produced);
+    }
+    return produced;
+}
+
+/*============================================================================
+ * Benchmark
+ * Float path: pn_*_to_float + pn_decimate per channel (what the receive
+ * loop does today). Q15 path: wf_q15_decim. Same synthetic tone + noise.
+ *============================================================================*/
+
+#define BENCH_SECONDS_OF_INPUT  0.5
+#define BENCH_FRONT_TRIALS      3
+
+static double now_seconds(void) {
+    return (double)SDL_GetPerformanceCounter() / (double)SDL_GetPerformanceFrequency();
+}
+
+static double bench_float(const void *raw, bool u8, int n, int factor, int rate, float *fbuf) {
+    double best = 1e30;
+    volatile float sink = 0.0f;
+    for (int t = 0; t < BENCH_FRONT_TRIALS; t++) {
+        pn_decimate_t dec_i, dec_q;
+        pn_decimate_init(&dec_i, factor, (float)rate);
+        pn_decimate_init(&dec_q, factor, (float)rate);
+        double start = now_seconds();
+        if (u8) pn_u8_to_float((const uint8_t*)raw, fbuf, n);
+        else pn_s16_to_float((const int16_t*)raw, fbuf, n);
+        float acc = 0.0f;
+        for (int s = 0; s < n; s++) {
+            float di, dq;
+            bool i_ready = pn_decimate_process(&dec_i, fbuf[2*s], &di);
+            bool q_ready = pn_decimate_process(&dec_q, fbuf[2*s + 1], &dq);
+            if (i_ready && q_ready) acc += di + dq;
+        }
+        double elapsed = now_seconds() - start;
+        sink += acc;
+        if (elapsed < best) best = elapsed;
+    }
+    (void)sink;
+    return best;
+}
+
+static double bench_q15(const void *raw, bool u8, int n, int factor, wf_q15_cpx *out) {
+    double best = 1e30;
+    volatile int sink = 0;
+    for (int t = 0; t < BENCH_FRONT_TRIALS; t++) {
+        wf_q15_decim_t dec;
+        if (!wf_q15_decim_init(&dec, factor, u8 ? 9 : 16)) return -1.0;
+        double start = now_seconds();
+        int produced = u8 ? wf_q15_decim_u8(&dec, (const uint8_t*)raw, n, out)
+                          : wf_q15_decim_s16(&dec, (const int16_t*)raw, n, out);
+        double elapsed = now_seconds() - start;
+        sink += produced ? out[produced - 1].r : 0;
+        if (elapsed < best) best = elapsed;
+    }
+    (void)sink;
+    return best;
+}
+
+void wf_fixed_benchmark(int sample_rate, int output_rate) {
+    int factor = sample_rate / output_rate;
+    int n = (int)(sample_rate * BENCH_SECONDS_OF_INPUT);
+    int16_t *s16 = (int16_t*)malloc(2 * n * sizeof(int16_t));
+    uint8_t *u8 = (uint8_t*)malloc(2 * n);
+    float *fbuf = (float*)malloc(2 * n * sizeof(float));
+    wf_q15_cpx *qbuf = (wf_q15_cpx*)malloc((n / 4 + 1) * sizeof(wf_q15_cpx));
+    if (!s16 || !u8 || !fbuf || !qbuf) {
+        fprintf(stderr, "Benchmark allocation failed\n");
+        free(s16); free(u8); free(fbuf); free(qbuf);
+        return;
+    }
+
+    /* Tone at 1 kHz plus noise, ~-6 dBFS */
+    uint32_t seed = 12345;
+    for (int s = 0; s < n; s++) {
+        double ph = 2.0 * 3.14159265358979323846 * 1000.0 * s / sample_rate;
+        seed = seed * 1664525u + 1013904223u;
+        double noise = ((seed >> 8) / 16777216.0 - 0.5) * 0.05;
+        double vi = 0.45 * cos(ph) + noise, vq = 0.45 * sin(ph) - noise;
+        s16[2*s] = (int16_t)(vi * 32767.0);
+        s16[2*s + 1] = (int16_t)(vq * 32767.0);
+        u8[2*s] = (uint8_t)(127.5 + vi * 127.0);
+        u8[2*s + 1] = (uint8_t)(127.5 + vq * 127.0);
+    }
+
+    printf("\nFront end: %d Hz -> %d Hz, %.1f s of input per trial\n",
+           sample_rate, output_rate, BENCH_SECONDS_OF_INPUT);
+    for (int pass = 0; pass < 2; pass++) {
+        bool is_u8 = (pass == 1);
+        const void *raw = is_u8 ? (const void*)u8 : (const void*)s16;
+        double tf = bench_float(raw, is_u8, n, factor, sample_rate, fbuf);
+        double tq = bench_q15(raw, is_u8, n, factor, qbuf);
+        printf("  %-4s float %6.2f ns/sample (%6.1fx realtime)", is_u8 ? "U8" : "S16",
+               tf * 1e9 / n, BENCH_SECONDS_OF_INPUT / tf);
+        if (tq > 0) {
+            printf("   q15 %6.2f ns/sample (%6.1fx realtime)   %.2fx\n",
+                   tq * 1e9 / n, BENCH_SECONDS_OF_INPUT / tq, tf / tq);
+        } else {
+            printf("   q15 n/a (decimation %d too small)\n", factor);
+        }
+    }
+
+    printf("\nFFT (windowed, per transform; error vs kiss_fft on noise input)\n");
+    static const int sizes[] = { 1024, 2048, 8192, 32768 };
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+        printf("  %5d:", sizes[k]);
+        for (int e = 0; e < WF_FFT_ENGINE_COUNT; e++) {
+            double err_db = 0.0;
+            double t = wf_fft_benchmark((wf_fft_engine_t)e, sizes[k], &err_db);
+            if (t < 0) continue;
+            printf("  %s %8.1f us (%6.1f dB)", wf_fft_engine_name((wf_fft_engine_t)e), t * 1e6, err_db);
+        }
+        printf("\n");
+    }
+    printf("\n");
+
+    free(s16);
+    free(u8);
+    free(fbuf);
+    free(qbuf);
+}
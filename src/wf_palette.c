@@ -0,0 +1,138 @@
+/**
+ * @file wf_palette.c
+ * @brief Colormap lookup table implementation
+ */
+
+#include "wf_palette.h"
+#include <string.h>
+
+static const char *g_palette_names[WF_PALETTE_COUNT] = {
+    "classic", "grayscale", "viridis"
+};
+
+const char* wf_palette_name(wf_palette_id_t id) {
+    if (id < 0 || id >= WF_PALETTE_COUNT) return g_palette_names[WF_PALETTE_CLASSIC];
+    return g_palette_names[id];
+}
+
+wf_palette_id_t wf_palette_from_name(const char* name) {
+    for (int p = 0; p < WF_PALETTE_COUNT; p++) {
+        if (name && strcmp(name, g_palette_names[p]) == 0) return (wf_palette_id_t)p;
+    }
+    return WF_PALETTE_CLASSIC;
+}
+
+/*============================================================================
+ * Table Generation (once per palette change)
+ *============================================================================*/
+
+static uint8_t to_byte(float v) {
+    if (v < 0.0f) v = 0.0f;
+    if (v > 1.0f) v = 1.0f;
+    return (uint8_t)(v * 255.0f + 0.5f);
+}
+
+static uint32_t pack(uint8_t r, uint8_t g, uint8_t b) {
+    return 0xFF000000u | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+}
+
+/* The original four-segment gradient */
+static uint32_t classic(float t) {
+    if (t < 0.25f) return pack(0, 0, (uint8_t)(t * 4.0f * 255.0f));
+    if (t < 0.5f) return pack(0, (uint8_t)((t - 0.25f) * 4.0f * 255.0f), 255);
+    if (t < 0.75f) return pack((uint8_t)((t - 0.5f) * 4.0f * 255.0f), 255,
+                               (uint8_t)((0.75f - t) * 4.0f * 255.0f));
+    return pack(255, (uint8_t)((1.0f - t) * 4.0f * 255.0f), 0);
+}
+
+/* Viridis, 6th-order polynomial fit per channel (within ~3/255) */
+static uint32_t viridis(float t) {
+    static const float c[7][3] = {
+        {  0.2777273272f,  0.0054073445f,   0.3340998053f },
+        {  0.1050930431f,  1.4046135299f,   1.3845901626f },
+        { -0.3308618287f,  0.2148475595f,   0.0950951630f },
+        { -4.6342304990f, -5.7991009734f, -19.3324409563f },
+        {  6.2282699363f, 14.1799333668f,  56.6905526007f },
+        {  4.7763849977f, -13.7451453777f, -65.3530326334f },
+        { -5.4354558559f,  4.6458526122f,  26.3124352496f },
+    };
+    float rgb[3];
+    for (int ch = 0; ch < 3; ch++) {
+        float v = c[6][ch];
+        for (int k = 5; k >= 0; k--) v = v * t + c[k][ch];
+        rgb[ch] = v;
+    }
+    return pack(to_byte(rgb[0]), to_byte(rgb[1]), to_byte(rgb[2]));
+}
+
+void wf_palette_build(wf_palette_t* pal, wf_palette_id_t id) {
+    if (id < 0 || id >= WF_PALETTE_COUNT) id = WF_PALETTE_CLASSIC;
+    pal->id = id;
+    for (int i = 0; i < WF_PALETTE_SIZE; i++) {
+        float t = (float)i / (float)(WF_PALETTE_SIZE - 1);
+        switch (id) {
+            case WF_PALETTE_GRAYSCALE: {
+                uint8_t v = to_byte(t);
+                pal->color[i] = pack(v, v, v);
+                break;
+            }
+            case WF_PALETTE_VIRIDIS:
+                pal->color[i] = viridis(t);
+                break;
+            default:
+                pal->color[i] = classic(t);
+                break;
+        }
+    }
+}
+
+void wf_palette_scale(float floor_db, float range_db, float gain_db,
+                      float* scale, float* offset) {
+    *scale = (float)(WF_PALETTE_SIZE - 1) / range_db;
+    *offset = (gain_db - floor_db) * *scale + 0.5f;    /* +0.5: round on truncate */
+}
+
+/*============================================================================
+ * Lookup (HOT PATH)
+ * Index pass is a straight float loop (mul-add, clamp, convert) that
+ * vectorizes; the gather pass then reads one packed entry per column.
+ *============================================================================*/
+
+#define MAP_BLOCK 256
+
+void wf_palette_map_argb(const wf_palette_t* pal, const float* db, int n,
+                         float scale, float offset, uint32_t* argb) {
+    int32_t idx[MAP_BLOCK];
+    const float top = (float)(WF_PALETTE_SIZE - 1);
+
+    for (int c0 = 0; c0 < n; c0 += MAP_BLOCK) {
+        int m = n - c0;
+        if (m > MAP_BLOCK) m = MAP_BLOCK;
+
+        const float *restrict src = db + c0;
+        for (int i = 0; i < m; i++) {
+            float v = src[i] * scale + offset;
+            v = (v < 0.0f) ? 0.0f : v;
+            v = (v > top) ? top : v;
+            idx[i] = (int32_t)v;
+        }
+
+        const uint32_t *restrict lut = pal->color;
+        uint32_t *restrict px = argb + c0;
+        for (int i = 0; i < m; i++) {
+            px[i] = lut[idx[i]];
+        }
+    }
+}
+
+void wf_palette_map_codes_argb(const wf_palette_t* pal, const uint8_t* codes, int n,
+                               float scale, float offset, uint32_t* argb) {
+    float db[MAP_BLOCK];
+    for (int c0 = 0; c0 < n; c0 += MAP_BLOCK) {
+        int m = n - c0;
+        if (m > MAP_BLOCK) m = MAP_BLOCK;
+        const uint8_t *restrict src = codes + c0;
+        for (int i = 0; i < m; i++) db[i] = (float)src[i];
+        wf_palette_map_argb(pal, db, m, scale, offset, argb + c0);
+    }
+}
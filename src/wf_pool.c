@@ -0,0 +1,139 @@
+/**
+ * @file wf_pool.c
+ * @brief Fork/join worker pool implementation
+ */
+
+#include "wf_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <SDL.h>
+
+typedef struct {
+    wf_pool_t *pool;
+    int index;
+} worker_arg_t;
+
+struct wf_pool {
+    int workers;
+    SDL_Thread **threads;
+    worker_arg_t *args;
+    SDL_mutex *lock;
+    SDL_cond *work_cv;
+    SDL_cond *done_cv;
+
+    /* Current batch (guarded by lock) */
+    wf_pool_fn fn;
+    void *ctx;
+    int jobs;
+    int next_job;
+    int jobs_done;
+    unsigned generation;
+    bool quit;
+};
+
+/* Claim and run jobs until none are left. Called with lock held. */
+static void drain_jobs(wf_pool_t *pool, int worker) {
+    while (pool->next_job < pool->jobs) {
+        int job = pool->next_job++;
+        SDL_UnlockMutex(pool->lock);
+        pool->fn(job, worker, pool->ctx);
+        SDL_LockMutex(pool->lock);
+        if (++pool->jobs_done == pool->jobs) {
+            SDL_CondSignal(pool->done_cv);
+        }
+    }
+}
+
+static int worker_main(void *data) {
+    worker_arg_t *arg = (worker_arg_t*)data;
+    wf_pool_t *pool = arg->pool;
+    unsigned seen = 0;
+
+    SDL_LockMutex(pool->lock);
+    for (;;) {
+        while (!pool->quit && pool->generation == seen) {
+            SDL_CondWait(pool->work_cv, pool->lock);
+        }
+        if (pool->quit) break;
+        seen = pool->generation;
+        drain_jobs(pool, arg->index);
+    }
+    SDL_UnlockMutex(pool->lock);
+    return 0;
+}
+
+wf_pool_t* wf_pool_create(int workers) {
+    if (workers < 0) workers = 0;
+
+    wf_pool_t *pool = (wf_pool_t*)calloc(1, sizeof(wf_pool_t));
+    if (!pool) return NULL;
+
+    pool->lock = SDL_CreateMutex();
+    pool->work_cv = SDL_CreateCond();
+    pool->done_cv = SDL_CreateCond();
+    pool->threads = (SDL_Thread**)calloc(workers + 1, sizeof(SDL_Thread*));
+    pool->args = (worker_arg_t*)calloc(workers + 1, sizeof(worker_arg_t));
+    if (!pool->lock || !pool->work_cv || !pool->done_cv || !pool->threads || !pool->args) {
+        wf_pool_destroy(pool);
+        return NULL;
+    }
+
+    for (int w = 0; w < workers; w++) {
+        pool->args[w].pool = pool;
+        pool->args[w].index = w + 1;
+        pool->threads[w] = SDL_CreateThread(worker_main, "wf_pool", &pool->args[w]);
+        if (!pool->threads[w]) {
+            fprintf(stderr, "Worker thread creation failed: %s\n", SDL_GetError());
+            break;
+        }
+        pool->workers++;
+    }
+    return pool;
+}
+
+int wf_pool_workers(const wf_pool_t* pool) {
+    return pool ? pool->workers : 0;
+}
+
+void wf_pool_run(wf_pool_t* pool, int jobs, wf_pool_fn fn, void* ctx) {
+    if (!pool || pool->workers == 0 || jobs < 2) {
+        for (int j = 0; j < jobs; j++) fn(j, 0, ctx);
+        return;
+    }
+
+    SDL_LockMutex(pool->lock);
+    pool->fn = fn;
+    pool->ctx = ctx;
+    pool->jobs = jobs;
+    pool->next_job = 0;
+    pool->jobs_done = 0;
+    pool->generation++;
+    SDL_CondBroadcast(pool->work_cv);
+
+    drain_jobs(pool, 0);    /* Caller works too */
+    while (pool->jobs_done < pool->jobs) {
+        SDL_CondWait(pool->done_cv, pool->lock);
+    }
+    SDL_UnlockMutex(pool->lock);
+}
+
+void wf_pool_destroy(wf_pool_t* pool) {
+    if (!pool) return;
+
+    if (pool->lock) {
+        SDL_LockMutex(pool->lock);
+        pool->quit = true;
+        if (pool->work_cv) SDL_CondBroadcast(pool->work_cv);
+        SDL_UnlockMutex(pool->lock);
+    }
+    for (int w = 0; w < pool->workers; w++) {
+        SDL_WaitThread(pool->threads[w], NULL);
+    }
+
+    if (pool->done_cv) SDL_DestroyCond(pool->done_cv);
+    if (pool->work_cv) SDL_DestroyCond(pool->work_cv);
+    if (pool->lock) SDL_DestroyMutex(pool->lock);
+    free(pool->threads);
+    free(pool->args);
+    free(pool);
+}
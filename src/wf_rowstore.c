@@ -0,0 +1,263 @@
+/**
+ * @file wf_rowstore.c
+ * @brief Memory-mapped row store implementation
+ *
+ * File layout: header, the partial mip rows (one per level), then each
+ * level as capacity rows of codes, capacity float bases and capacity
+ * spans.
+ */
+
+#include "wf_rowstore.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define ROWSTORE_MAGIC      "PHXROWS2"
+#define ROWSTORE_PAGE       4096
+
+struct wf_rowstore_header {
+    char magic[8];
+    uint32_t width;
+    uint32_t levels;
+    uint32_t capacity;
+    float step_db;
+    uint64_t written[WF_ROWSTORE_MAX_LEVELS];
+    float pending_base[WF_ROWSTORE_MAX_LEVELS];
+    uint32_t pending_count[WF_ROWSTORE_MAX_LEVELS];
+    wf_rowstore_span_t pending_span[WF_ROWSTORE_MAX_LEVELS];
+};
+
+static size_t align_up(size_t n, size_t a) {
+    return (n + a - 1) / a * a;
+}
+
+static size_t pending_offset(void) {
+    return align_up(sizeof(wf_rowstore_header_t), 64);
+}
+
+static size_t data_offset(int width, int levels) {
+    return align_up(pending_offset() + (size_t)width * levels, ROWSTORE_PAGE);
+}
+
+static uint8_t* pending_row(const wf_rowstore_t* st, int level) {
+    return st->map + pending_offset() + (size_t)level * st->width;
+}
+
+static uint8_t* level_codes(const wf_rowstore_t* st, int level) {
+    return st->map + data_offset(st->width, st->levels) + (size_t)level * st->level_bytes;
+}
+
+static float* level_bases(const wf_rowstore_t* st, int level) {
+    return (float*)(level_codes(st, level) + align_up((size_t)st->capacity * st->width, 64));
+}
+
+static wf_rowstore_span_t* level_spans(const wf_rowstore_t* st, int level) {
+    return (wf_rowstore_span_t*)((uint8_t*)level_bases(st, level) +
+                                 align_up((size_t)st->capacity * sizeof(float), 64));
+}
+
+static bool same_span(const wf_rowstore_span_t* a, const wf_rowstore_span_t* b) {
+    return a->center_hz == b->center_hz && a->left_hz == b->left_hz && a->right_hz == b->right_hz;
+}
+
+/*============================================================================
+ * Mapping
+ *============================================================================*/
+
+#ifdef _WIN32
+
+static bool map_file(wf_rowstore_t* st, const char* path, size_t size, bool* fresh) {
+    st->file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL,
+                           OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (st->file == INVALID_HANDLE_VALUE) {
+        st->file = NULL;
+        return false;
+    }
+
+    LARGE_INTEGER current;
+    *fresh = !GetFileSizeEx(st->file, &current) || (uint64_t)current.QuadPart != size;
+    if (*fresh) {
+        LARGE_INTEGER zero = { 0 }, end;
+        end.QuadPart = (LONGLONG)size;
+        /* Truncate first so stale contents don't survive a geometry change */
+        if (!SetFilePointerEx(st->file, zero, NULL, FILE_BEGIN) || !SetEndOfFile(st->file) ||
+            !SetFilePointerEx(st->file, end, NULL, FILE_BEGIN) || !SetEndOfFile(st->file)) {
+            return false;
+        }
+    }
+
+    st->mapping = CreateFileMappingA(st->file, NULL, PAGE_READWRITE,
+                                     (DWORD)((uint64_t)size >> 32), (DWORD)size, NULL);
+    if (!st->mapping) return false;
+    st->map = (uint8_t*)MapViewOfFile(st->mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    return st->map != NULL;
+}
+
+static void unmap_file(wf_rowstore_t* st) {
+    if (st->map) {
+        FlushViewOfFile(st->map, 0);
+        UnmapViewOfFile(st->map);
+    }
+    if (st->mapping) CloseHandle(st->mapping);
+    if (st->file) CloseHandle(st->file);
+    st->map = NULL;
+    st->mapping = NULL;
+    st->file = NULL;
+}
+
+#else
+
+static bool map_file(wf_rowstore_t* st, const char* path, size_t size, bool* fresh) {
+    st->fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (st->fd < 0) return false;
+
+    struct stat sb;
+    *fresh = fstat(st->fd, &sb) != 0 || (uint64_t)sb.st_size != size;
+    if (*fresh) {
+        /* Truncate first so stale contents don't survive a geometry change;
+         * the extension is sparse until rows are written */
+        if (ftruncate(st->fd, 0) != 0 || ftruncate(st->fd, (off_t)size) != 0) return false;
+    }
+
+    void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, st->fd, 0);
+    if (p == MAP_FAILED) return false;
+    st->map = (uint8_t*)p;
+    return true;
+}
+
+static void unmap_file(wf_rowstore_t* st) {
+    if (st->map) munmap(st->map, st->map_size);
+    if (st->fd >= 0) close(st->fd);
+    st->map = NULL;
+    st->fd = -1;
+}
+
+#endif
+
+/*============================================================================
+ * Public API
+ *============================================================================*/
+
+bool wf_rowstore_open(wf_rowstore_t* st, const char* path, int width,
+                      int capacity, int levels, float step_db) {
+    memset(st, 0, sizeof(*st));
+#ifndef _WIN32
+    st->fd = -1;
+#endif
+    if (width <= 0 || capacity <= 0 || levels <= 0) return false;
+    if (levels > WF_ROWSTORE_MAX_LEVELS) levels = WF_ROWSTORE_MAX_LEVELS;
+
+    st->width = width;
+    st->levels = levels;
+    st->capacity = capacity;
+    st->step_db = step_db;
+    st->level_bytes = align_up(align_up((size_t)capacity * width, 64) +
+                               align_up((size_t)capacity * sizeof(float), 64) +
+                               (size_t)capacity * sizeof(wf_rowstore_span_t), ROWSTORE_PAGE);
+    st->map_size = data_offset(width, levels) + st->level_bytes * levels;
+
+    bool fresh = true;
+    if (!map_file(st, path, st->map_size, &fresh)) {
+        fprintf(stderr, "Row store: cannot map %s (%zu MB)\n", path, st->map_size >> 20);
+        unmap_file(st);
+        return false;
+    }
+    st->header = (wf_rowstore_header_t*)st->map;
+
+    wf_rowstore_header_t* h = st->header;
+    if (fresh || memcmp(h->magic, ROWSTORE_MAGIC, sizeof(h->magic)) != 0 ||
+        h->width != (uint32_t)width || h->levels != (uint32_t)levels ||
+        h->capacity != (uint32_t)capacity || h->step_db != step_db) {
+        memset(h, 0, sizeof(*h));
+        memcpy(h->magic, ROWSTORE_MAGIC, sizeof(h->magic));
+        h->width = (uint32_t)width;
+        h->levels = (uint32_t)levels;
+        h->capacity = (uint32_t)capacity;
+        h->step_db = step_db;
+    }
+    return true;
+}
+
+void wf_rowstore_close(wf_rowstore_t* st) {
+    unmap_file(st);
+    st->header = NULL;
+}
+
+static void put_row(wf_rowstore_t* st, int level, const uint8_t* codes, float base_db,
+                    const wf_rowstore_span_t* span);
+
+/* Fold a completed level-1 row into the partial row of level. Both are
+ * rebased to the higher base so peaks stay exact; whatever drops below
+ * code 0 was far under the noise floor anyway. Columns of different spans
+ * are different frequencies, so then the newer row simply replaces it. */
+static void merge_row(wf_rowstore_t* st, int level, const uint8_t* codes, float base_db,
+                      const wf_rowstore_span_t* span) {
+    wf_rowstore_header_t* h = st->header;
+    uint8_t* restrict acc = pending_row(st, level);
+    const int width = st->width;
+
+    if (h->pending_count[level] == 0 || !same_span(&h->pending_span[level], span)) {
+        memcpy(acc, codes, width);
+        h->pending_base[level] = base_db;
+        h->pending_span[level] = *span;
+    } else {
+        float hi = (base_db > h->pending_base[level]) ? base_db : h->pending_base[level];
+        int shift_acc = (int)((hi - h->pending_base[level]) / st->step_db + 0.5f);
+        int shift_new = (int)((hi - base_db) / st->step_db + 0.5f);
+        /* One of the shifts is 0, so the max is never negative */
+        for (int c = 0; c < width; c++) {
+            int a = acc[c] - shift_acc;
+            int b = codes[c] - shift_new;
+            acc[c] = (uint8_t)((a > b) ? a : b);
+        }
+        h->pending_base[level] = hi;
+    }
+
+    if (++h->pending_count[level] == 2) {
+        h->pending_count[level] = 0;
+        put_row(st, level, acc, h->pending_base[level], &h->pending_span[level]);
+    }
+}
+
+static void put_row(wf_rowstore_t* st, int level, const uint8_t* codes, float base_db,
+                    const wf_rowstore_span_t* span) {
+    wf_rowstore_header_t* h = st->header;
+    size_t slot = (size_t)(h->written[level] % (uint64_t)st->capacity);
+    memcpy(level_codes(st, level) + slot * st->width, codes, st->width);
+    level_bases(st, level)[slot] = base_db;
+    level_spans(st, level)[slot] = *span;
+    h->written[level]++;
+
+    if (level + 1 < st->levels) merge_row(st, level + 1, codes, base_db, span);
+}
+
+void wf_rowstore_append(wf_rowstore_t* st, const uint8_t* codes, float base_db,
+                        const wf_rowstore_span_t* span) {
+    if (!st->header) return;
+    put_row(st, 0, codes, base_db, span);
+}
+
+uint64_t wf_rowstore_written(const wf_rowstore_t* st, int level) {
+    if (!st->header || level < 0 || level >= st->levels) return 0;
+    return st->header->written[level];
+}
+
+const uint8_t* wf_rowstore_row(const wf_rowstore_t* st, int level,
+                               uint64_t index, float* base_db, wf_rowstore_span_t* span) {
+    if (!st->header || level < 0 || level >= st->levels) return NULL;
+    uint64_t written = st->header->written[level];
+    if (index >= written || written - index > (uint64_t)st->capacity) return NULL;
+
+    size_t slot = (size_t)(index % (uint64_t)st->capacity);
+    if (base_db) *base_db = level_bases(st, level)[slot];
+    if (span) *span = level_spans(st, level)[slot];
+    return level_codes(st, level) + slot * st->width;
+}
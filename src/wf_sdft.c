@@ -0,0 +1,118 @@
+/**
+ * @file wf_sdft.c
+ * @brief Sliding DFT implementation
+ */
+
+#include "wf_sdft.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "kiss_fft.h"
+
+static bool grow(void **ptr, int count, size_t elem) {
+    void *p = realloc(*ptr, count * elem);
+    if (!p) return false;
+    *ptr = p;
+    return true;
+}
+
+void wf_sdft_free(wf_sdft_t* sdft) {
+    free(sdft->re);
+    free(sdft->im);
+    free(sdft->w_re);
+    free(sdft->w_im);
+    free(sdft->col_slot);
+    free(sdft->col_bin);
+    memset(sdft, 0, sizeof(*sdft));
+}
+
+bool wf_sdft_configure(wf_sdft_t* sdft, const wf_colmap_t* map, int size,
+                       const float* history) {
+    const int cols = map->columns;
+    const int half = size / 2;
+
+    if (cols > sdft->col_capacity) {
+        if (!grow((void**)&sdft->col_slot, 3 * cols, sizeof(int)) ||
+            !grow((void**)&sdft->col_bin, cols, sizeof(int))) return false;
+        sdft->col_capacity = cols;
+    }
+    if (3 * cols > sdft->capacity) {
+        int cap = 3 * cols;
+        if (!grow((void**)&sdft->re, cap, sizeof(double)) ||
+            !grow((void**)&sdft->im, cap, sizeof(double)) ||
+            !grow((void**)&sdft->w_re, cap, sizeof(double)) ||
+            !grow((void**)&sdft->w_im, cap, sizeof(double))) return false;
+        sdft->capacity = cap;
+    }
+
+    /* slot_of[shifted bin] - dedupe neighbours shared between columns */
+    int *slot_of = (int*)malloc(size * sizeof(int));
+    kiss_fft_cpx *fft_out = (kiss_fft_cpx*)malloc(size * sizeof(kiss_fft_cpx));
+    kiss_fft_cfg cfg = kiss_fft_alloc(size, 0, NULL, NULL);
+    if (!slot_of || !fft_out || !cfg) {
+        free(slot_of);
+        free(fft_out);
+        kiss_fft_free(cfg);
+        return false;
+    }
+    for (int k = 0; k < size; k++) slot_of[k] = -1;
+
+    /* Seed with the exact (rectangular) DFT of the current history */
+    kiss_fft(cfg, (const kiss_fft_cpx*)history, fft_out);
+
+    sdft->size = size;
+    sdft->columns = cols;
+    sdft->count = 0;
+    for (int c = 0; c < cols; c++) {
+        int center = map->start[c];     /* Shifted index, DC at size/2 */
+        for (int d = -1; d <= 1; d++) {
+            int shifted = (center + d + size) & (size - 1);
+            if (slot_of[shifted] < 0) {
+                int slot = sdft->count++;
+                int natural = (shifted + half) & (size - 1);
+                double w = 2.0 * 3.14159265358979323846 * (shifted - half) / size;
+                sdft->w_re[slot] = cos(w);
+                sdft->w_im[slot] = sin(w);
+                sdft->re[slot] = fft_out[natural].r;
+                sdft->im[slot] = fft_out[natural].i;
+                slot_of[shifted] = slot;
+            }
+            sdft->col_slot[3*c + d + 1] = slot_of[shifted];
+        }
+        sdft->col_bin[c] = (center + half) & (size - 1);
+    }
+
+    free(slot_of);
+    free(fft_out);
+    kiss_fft_free(cfg);
+    return true;
+}
+
+/* HOT PATH - every tracked bin, every sample. Straight SoA loop. */
+void wf_sdft_update(wf_sdft_t* sdft, float new_i, float new_q, float old_i, float old_q) {
+    const double dr = (double)new_i - old_i;
+    const double di = (double)new_q - old_q;
+    double *restrict re = sdft->re;
+    double *restrict im = sdft->im;
+    const double *restrict wr = sdft->w_re;
+    const double *restrict wi = sdft->w_im;
+    for (int k = 0; k < sdft->count; k++) {
+        double a = re[k] + dr;
+        double b = im[k] + di;
+        re[k] = a * wr[k] - b * wi[k];
+        im[k] = a * wi[k] + b * wr[k];
+    }
+}
+
+void wf_sdft_power(const wf_sdft_t* sdft, float* power) {
+    const int *slot = sdft->col_slot;
+    for (int c = 0; c < sdft->columns; c++, slot += 3) {
+        /* Columns narrower than a bin share their center */
+        if (c > 0 && sdft->col_bin[c] == sdft->col_bin[c - 1]) continue;
+        /* Hann in frequency: 0.5*X[k] - 0.25*(X[k-1] + X[k+1]) */
+        double yr = 0.5 * sdft->re[slot[1]] - 0.25 * (sdft->re[slot[0]] + sdft->re[slot[2]]);
+        double yi = 0.5 * sdft->im[slot[1]] - 0.25 * (sdft->im[slot[0]] + sdft->im[slot[2]]);
+        power[sdft->col_bin[c]] = (float)(yr * yr + yi * yi);
+    }
+}
@@ -0,0 +1,446 @@
+/**
+ * @file wf_spectrum.c
+ * @brief Per-bin power spectrum processing implementation
+ */
+
+#include "wf_spectrum.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+/*============================================================================
+ * Welch Averaging
+ *============================================================================*/
+
+bool wf_welch_init(wf_welch_t* welch, int max_bins) {
+    memset(welch, 0, sizeof(*welch));
+    welch->acc = (float*)calloc(max_bins, sizeof(float));
+    welch->power = (float*)calloc(max_bins, sizeof(float));
+    welch->bins = max_bins;
+    welch->frames = 1;
+    return welch->acc && welch->power;
+}
+
+void wf_welch_free(wf_welch_t* welch) {
+    free(welch->acc);
+    free(welch->power);
+    memset(welch, 0, sizeof(*welch));
+}
+
+void wf_welch_configure(wf_welch_t* welch, int bins, int frames, bool max_hold) {
+    if (frames < 1) frames = 1;
+    if (frames > WF_WELCH_MAX_FRAMES) frames = WF_WELCH_MAX_FRAMES;
+    welch->bins = bins;
+    welch->frames = frames;
+    welch->max_hold = max_hold;
+    welch->count = 0;
+    memset(welch->acc, 0, bins * sizeof(float));
+}
+
+/* HOT PATH - |X|^2 per bin, run by whichever worker did the FFT */
+void wf_fft_power(const kiss_fft_cpx* fft_out, float* power, int n) {
+    const float *restrict x = (const float*)fft_out;
+    float *restrict p = power;
+    for (int k = 0; k < n; k++) {
+        p[k] = x[2*k]*x[2*k] + x[2*k+1]*x[2*k+1];
+    }
+}
+
+static void emit_half(const float *restrict p, float *restrict acc, float *restrict power,
+                      int n, bool max_hold, int frames) {
+    if (max_hold) {
+        for (int k = 0; k < n; k++) {
+            power[k] = (p[k] > acc[k]) ? p[k] : acc[k];
+            acc[k] = 0.0f;
+        }
+    } else {
+        const float scale = 1.0f / (float)frames;
+        for (int k = 0; k < n; k++) {
+            power[k] = (acc[k] + p[k]) * scale;
+            acc[k] = 0.0f;
+        }
+    }
+}
+
+/* HOT PATH - one pass over the bins per hop, in hop order */
+bool wf_welch_add(wf_welch_t* welch, const float* frame_power) {
+    const int n = welch->bins;
+    const float *restrict p = frame_power;
+    float *restrict acc = welch->acc;
+
+    if (++welch->count < welch->frames) {
+        if (welch->max_hold) {
+            for (int k = 0; k < n; k++) {
+                acc[k] = (p[k] > acc[k]) ? p[k] : acc[k];
+            }
+        } else {
+            for (int k = 0; k < n; k++) {
+                acc[k] += p[k];
+            }
+        }
+        return false;
+    }
+
+    /* Last frame of the row: emit (FFT-shifted, DC at bins/2) and reset the
+     * accumulator in the same pass. Each half is a unit-stride loop. */
+    const int half = n / 2;
+    emit_half(p, acc, welch->power + half, half, welch->max_hold, welch->frames);
+    emit_half(p + half, acc + half, welch->power, half, welch->max_hold, welch->frames);
+    welch->count = 0;
+    return true;
+}
+
+/*============================================================================
+ * Column Mapping
+ * Column c spans [f_lo + c*df, f_lo + (c+1)*df). A bin belongs to the
+ * column whose span contains its center frequency.
+ *============================================================================*/
+
+void wf_colmap_free(wf_colmap_t* map) {
+    free(map->start);
+    free(map->count);
+    free(map->weight);
+    memset(map, 0, sizeof(*map));
+}
+
+bool wf_colmap_build(wf_colmap_t* map, int columns, int bins, float bin_hz,
+                     float f_lo, float f_hi, bool nearest) {
+    if (columns > map->capacity) {
+        int *start = (int*)realloc(map->start, columns * sizeof(int));
+        if (start) map->start = start;
+        int *count = (int*)realloc(map->count, columns * sizeof(int));
+        if (count) map->count = count;
+        float *weight = (float*)realloc(map->weight, columns * sizeof(float));
+        if (weight) map->weight = weight;
+        if (!start || !count || !weight) return false;
+        map->capacity = columns;
+    }
+
+    map->columns = columns;
+    map->bins = bins;
+    map->max_count = 1;
+
+    const double df = (double)(f_hi - f_lo) / columns;
+    const double center = bins / 2;     /* Bin index of DC (FFT-shifted) */
+    map->interpolate = !nearest && df < bin_hz;
+
+    for (int c = 0; c < columns; c++) {
+        if (nearest) {
+            double u = (f_lo + (c + 0.5) * df) / bin_hz + center;
+            int k = (int)floor(u + 0.5);
+            if (k < 0) k = 0;
+            if (k > bins - 1) k = bins - 1;
+            map->start[c] = k;
+            map->count[c] = 1;
+            map->weight[c] = 1.0f;
+        } else if (map->interpolate) {
+            /* Bins wider than pixels: interpolate at the column center */
+            double u = (f_lo + (c + 0.5) * df) / bin_hz + center;
+            int i0 = (int)floor(u);
+            float frac = (float)(u - i0);
+            if (i0 < 0) { i0 = 0; frac = 0.0f; }
+            if (i0 > bins - 2) { i0 = bins - 2; frac = 1.0f; }
+            map->start[c] = i0;
+            map->count[c] = 2;
+            map->weight[c] = frac;
+        } else {
+            int lo = (int)ceil((f_lo + c * df) / bin_hz + center);
+            int hi = (int)ceil((f_lo + (c + 1) * df) / bin_hz + center);
+            if (lo < 0) lo = 0;
+            if (hi > bins) hi = bins;
+            if (hi <= lo) {
+                lo = (lo >= bins) ? bins - 1 : lo;
+                hi = lo + 1;
+            }
+            map->start[c] = lo;
+            map->count[c] = hi - lo;
+            map->weight[c] = 1.0f / (float)(hi - lo);
+            if (hi - lo > map->max_count) map->max_count = hi - lo;
+        }
+    }
+    return true;
+}
+
+/* HOT PATH - once per row. Loops run across columns (gather per step) so
+ * they vectorize regardless of how many bins each column covers. */
+void wf_colmap_apply(const wf_colmap_t* map, const float* power,
+                     wf_pool_mode_t mode, int first, int cols, float* out) {
+    const int *restrict start = map->start + first;
+    const int *restrict count = map->count + first;
+    const float *restrict weight = map->weight + first;
+    float *restrict dst = out;
+
+    if (map->interpolate) {
+        for (int c = 0; c < cols; c++) {
+            float p0 = power[start[c]];
+            float p1 = power[start[c] + 1];
+            dst[c] = p0 + weight[c] * (p1 - p0);
+        }
+        return;
+    }
+
+    for (int c = 0; c < cols; c++) {
+        dst[c] = power[start[c]];
+    }
+
+    if (mode == WF_POOL_MAX) {
+        /* Steps past a column's last bin re-read that bin - harmless for max */
+        for (int t = 1; t < map->max_count; t++) {
+            for (int c = 0; c < cols; c++) {
+                int last = start[c] + count[c] - 1;
+                int idx = start[c] + t;
+                float p = power[(idx < last) ? idx : last];
+                dst[c] = (p > dst[c]) ? p : dst[c];
+            }
+        }
+    } else {
+        for (int t = 1; t < map->max_count; t++) {
+            for (int c = 0; c < cols; c++) {
+                int last = start[c] + count[c] - 1;
+                int idx = start[c] + t;
+                float p = power[(idx < last) ? idx : last];
+                dst[c] += (t < count[c]) ? p : 0.0f;
+            }
+        }
+        for (int c = 0; c < cols; c++) {
+            dst[c] *= weight[c];
+        }
+    }
+}
+
+/*============================================================================
+ * Power -> dB (fast log2)
+ * x = 2^e * m with m in [sqrt(1/2), sqrt(2)), then
+ * log2(m) = 2/ln2 * atanh(t), t = (m-1)/(m+1), |t| < 0.172, two series
+ * terms. Max error ~3e-4 dB over the full float range. Branch-free, so
+ * the loop vectorizes.
+ *============================================================================*/
+
+#define DB_PER_LOG2     3.0102999566f   /* 10*log10(2) */
+#define POWER_EPSILON   1e-20f          /* Floor: -200 dB, keeps log finite */
+
+static inline float fast_log2(float x) {
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    uint32_t u = bits - 0x3F3504F3u;            /* Offset by sqrt(1/2) */
+    int32_t e = (int32_t)u >> 23;
+    uint32_t m_bits = (u & 0x007FFFFFu) + 0x3F3504F3u;
+    float m;
+    memcpy(&m, &m_bits, sizeof(m));
+    float t = (m - 1.0f) / (m + 1.0f);
+    float t2 = t * t;
+    return (float)e + t * (2.8853900818f + t2 * 0.9617966939f);
+}
+
+/* HOT PATH - once per column per row */
+void wf_power_to_db(const float* power, float* db, int n, float offset_db) {
+    const float *restrict src = power;
+    float *restrict dst = db;
+    for (int i = 0; i < n; i++) {
+        dst[i] = DB_PER_LOG2 * fast_log2(src[i] + POWER_EPSILON) + offset_db;
+    }
+}
+
+/*============================================================================
+ * Noise Floor Flattening
+ *============================================================================*/
+
+bool wf_flatten_init(wf_flatten_t* fl, int max_bins, float quantile) {
+    memset(fl, 0, sizeof(*fl));
+    fl->level = (float*)malloc(max_bins * sizeof(float));
+    fl->gain = (float*)malloc(max_bins * sizeof(float));
+    if (!fl->level || !fl->gain) {
+        wf_flatten_free(fl);
+        return false;
+    }
+    fl->capacity = max_bins;
+    fl->quantile = quantile;
+    return true;
+}
+
+void wf_flatten_free(wf_flatten_t* fl) {
+    free(fl->level);
+    free(fl->gain);
+    memset(fl, 0, sizeof(*fl));
+}
+
+void wf_flatten_reset(wf_flatten_t* fl) {
+    fl->bins = 0;
+    fl->phase = 0;
+}
+
+/* Quantile tracker over [lo, hi): moves up by step*q when the sample is
+ * above the estimate and down by step*(1-q) when below, which settles where
+ * a fraction q of samples fall below it */
+static void flatten_track(wf_flatten_t *fl, const float *power, int lo, int hi, float step) {
+    const float up = step * fl->quantile;
+    const float down = step * (1.0f - fl->quantile);
+    float *restrict level = fl->level;
+    float *restrict gain = fl->gain;
+    for (int k = lo; k < hi; k++) {
+        float l = fast_log2(power[k] + POWER_EPSILON);
+        level[k] += (l < level[k]) ? -down : up;
+        gain[k] = exp2f(-level[k]);
+    }
+}
+
+void wf_flatten_apply(wf_flatten_t* fl, float* power, int bins,
+                      float db_per_second, float row_seconds) {
+    if (bins > fl->capacity) return;
+
+    if (fl->bins != bins) {
+        /* Prime from this row */
+        float *restrict level = fl->level;
+        float *restrict gain = fl->gain;
+        for (int k = 0; k < bins; k++) {
+            level[k] = fast_log2(power[k] + POWER_EPSILON);
+            gain[k] = exp2f(-level[k]);
+        }
+        fl->bins = bins;
+        fl->phase = 0;
+    } else {
+        /* Each bin is visited every WF_FLATTEN_SLICES rows */
+        int chunk = (bins + WF_FLATTEN_SLICES - 1) / WF_FLATTEN_SLICES;
+        int lo = fl->phase * chunk;
+        int hi = (lo + chunk < bins) ? lo + chunk : bins;
+        float step = db_per_second / DB_PER_LOG2 * row_seconds * WF_FLATTEN_SLICES;
+        flatten_track(fl, power, lo, hi, step);
+        if (++fl->phase == WF_FLATTEN_SLICES) fl->phase = 0;
+    }
+
+    float *restrict dst = power;
+    const float *restrict gain = fl->gain;
+    for (int k = 0; k < bins; k++) dst[k] *= gain[k];
+}
+
+/*============================================================================
+ * Percentile AGC
+ *============================================================================*/
+
+void wf_agc_init(wf_agc_t* agc, float floor_pct, float peak_pct,
+                 float attack_s, float decay_s, float floor_db, float peak_db) {
+    memset(agc, 0, sizeof(*agc));
+    agc->floor_pct = floor_pct;
+    agc->peak_pct = peak_pct;
+    agc->attack_s = attack_s;
+    agc->decay_s = decay_s;
+    agc->floor_db = floor_db;
+    agc->peak_db = peak_db;
+}
+
+#define AGC_BLOCK 256
+
+/* HOT PATH - bin index pass vectorizes; the increment pass is one
+ * scalar add per column */
+void wf_agc_accumulate(wf_agc_t* agc, const float* db, int n) {
+    int32_t idx[AGC_BLOCK];
+    const float top = (float)(WF_AGC_HIST_BINS - 1);
+
+    for (int c0 = 0; c0 < n; c0 += AGC_BLOCK) {
+        int m = n - c0;
+        if (m > AGC_BLOCK) m = AGC_BLOCK;
+
+        const float *restrict src = db + c0;
+        for (int i = 0; i < m; i++) {
+            float v = src[i] - WF_AGC_HIST_MIN_DB;
+            v = (v < 0.0f) ? 0.0f : v;
+            v = (v > top) ? top : v;
+            idx[i] = (int32_t)v;
+        }
+        for (int i = 0; i < m; i++) agc->hist[idx[i]]++;
+    }
+    agc->count += (uint32_t)n;
+}
+
+/* dB value below which pct of the row lies, interpolated within a bin */
+static float hist_percentile(const wf_agc_t *agc, float pct) {
+    float target = pct * (float)agc->count;
+    float cum = 0.0f;
+    for (int b = 0; b < WF_AGC_HIST_BINS; b++) {
+        float next = cum + (float)agc->hist[b];
+        if (next >= target && agc->hist[b] > 0) {
+            float frac = (target - cum) / (float)agc->hist[b];
+            return WF_AGC_HIST_MIN_DB + (float)b + frac;
+        }
+        cum = next;
+    }
+    return WF_AGC_HIST_MIN_DB + (float)WF_AGC_HIST_BINS;
+}
+
+static float time_alpha(float tau_s, float dt_s) {
+    if (tau_s <= 0.0f) return 1.0f;
+    return 1.0f - expf(-dt_s / tau_s);
+}
+
+void wf_agc_update(wf_agc_t* agc, float row_seconds) {
+    if (agc->count == 0) return;
+
+    float floor_db = hist_percentile(agc, agc->floor_pct);
+    float peak_db = hist_percentile(agc, agc->peak_pct);
+    float attack = time_alpha(agc->attack_s, row_seconds);
+    float decay = time_alpha(agc->decay_s, row_seconds);
+
+    /* Widen fast, narrow slowly */
+    agc->peak_db += ((peak_db > agc->peak_db) ? attack : decay) * (peak_db - agc->peak_db);
+    agc->floor_db += ((floor_db < agc->floor_db) ? attack : decay) * (floor_db - agc->floor_db);
+
+    memset(agc->hist, 0, sizeof(agc->hist));
+    agc->count = 0;
+}
+
+/*============================================================================
+ * Spectrum Traces
+ *============================================================================*/
+
+bool wf_trace_resize(wf_trace_t* tr, int columns) {
+    if (columns > tr->capacity) {
+        wf_trace_free(tr);
+        tr->current = (float*)malloc(columns * sizeof(float));
+        tr->average = (float*)malloc(columns * sizeof(float));
+        tr->peak = (float*)malloc(columns * sizeof(float));
+        if (!tr->current || !tr->average || !tr->peak) {
+            wf_trace_free(tr);
+            return false;
+        }
+        tr->capacity = columns;
+    }
+    tr->columns = columns;
+    wf_trace_reset(tr);
+    return true;
+}
+
+void wf_trace_free(wf_trace_t* tr) {
+    free(tr->current);
+    free(tr->average);
+    free(tr->peak);
+    memset(tr, 0, sizeof(*tr));
+}
+
+void wf_trace_reset(wf_trace_t* tr) {
+    tr->primed = false;
+}
+
+/* HOT PATH - three independent column loops, each vectorizes */
+void wf_trace_update(wf_trace_t* tr, const uint8_t* codes, float base_db, float step_db,
+                     float avg_alpha, float peak_decay_db) {
+    const int n = tr->columns;
+    float *restrict cur = tr->current;
+    float *restrict avg = tr->average;
+    float *restrict peak = tr->peak;
+
+    for (int c = 0; c < n; c++) cur[c] = base_db + (float)codes[c] * step_db;
+
+    if (!tr->primed) {
+        memcpy(avg, cur, n * sizeof(float));
+        memcpy(peak, cur, n * sizeof(float));
+        tr->primed = true;
+        return;
+    }
+
+    for (int c = 0; c < n; c++) avg[c] += avg_alpha * (cur[c] - avg[c]);
+    for (int c = 0; c < n; c++) {
+        float p = peak[c] - peak_decay_db;
+        peak[c] = (cur[c] > p) ? cur[c] : p;
+    }
+}